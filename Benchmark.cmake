@@ -0,0 +1,7 @@
+## Compile flags of the benchmark targets, included from the benchmark
+## directory of a module. A module builds its tests with sanitizers,
+## coverage and -O0 in CMAKE_CXX_FLAGS, which every target of the
+## directory shares, so the benchmarks live in a directory of their own
+## that starts over from the cached flags and builds optimized
+set (CMAKE_CXX_FLAGS "$CACHE{CMAKE_CXX_FLAGS} -DEX2 -std=c++20 -Wpedantic -Werror -Wall -Wextra")
+set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -O2 -DNDEBUG")
@@ -19,9 +19,19 @@
  * @brief STL complaint allocator
  * As std::allocator, this one is stateless
  * It's implemented using C++20 and can be used in constexpr contexts
+ * allocate returns uninitialized storage, element lifetimes are handled by
+ * construct and destroy
+ * Storage for types with fundamental alignment comes from malloc, so
+ * reallocate can hand blocks of trivially relocatable elements to realloc
  */
 
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 namespace jtl {
 
 template <typename T>
@@ -41,10 +51,68 @@ class allocator {
     constexpr ~allocator() = default;
 
     [[nodiscard]] constexpr T *allocate(size_type n) {
-        return new T[n]{};
+        if (std::is_constant_evaluated()) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        if constexpr (Over_Aligned) {
+            return static_cast<T *>(::operator new(
+                    bytes(n), std::align_val_t{alignof(T)}));
+        } else {
+            return checked(std::malloc(bytes(n)));
+        }
     }
     constexpr void deallocate(T *p, [[maybe_unused]] size_type n = 0) {
-        delete[] p;
+        if (std::is_constant_evaluated()) {
+            std::allocator<T>{}.deallocate(p, n);
+        } else if constexpr (Over_Aligned) {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+        } else {
+            std::free(p);
+        }
+    }
+
+    // Resizes a block holding trivially relocatable elements, the contents
+    // of the first min(old_n, new_n) slots are kept. realloc may extend the
+    // block in place, and remaps the pages of large blocks instead of
+    // copying them
+    [[nodiscard]] T *reallocate(T *p, [[maybe_unused]] size_type old_n,
+            size_type new_n)
+        requires(alignof(T) <= alignof(std::max_align_t)) {
+        return checked(std::realloc(static_cast<void *>(p), bytes(new_n)));
+    }
+
+    template <typename U, typename... Args>
+    constexpr void construct(U *p, Args &&...args) {
+        std::construct_at(p, std::forward<Args>(args)...);
+    }
+    template <typename U>
+    constexpr void destroy(U *p) {
+        std::destroy_at(p);
+    }
+
+    template <class U>
+    constexpr bool operator==(
+            [[maybe_unused]] const allocator<U> &other) const noexcept {
+        return true;
+    }
+
+ private:
+    static constexpr auto Over_Aligned =
+            alignof(T) > alignof(std::max_align_t);
+
+    // Zero sized requests still get a unique block back
+    static constexpr std::size_t bytes(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n == 0 ? 1 : n * sizeof(T);
+    }
+
+    static T *checked(void *ptr) {
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(ptr);
     }
 };
 
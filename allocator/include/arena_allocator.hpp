@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+/**
+ * @brief Monotonic arena and the STL complaint allocator drawing from it
+ * The arena bumps a pointer through a caller-owned buffer and chains heap
+ * chunks once the buffer is exhausted. Deallocation is a no-op, memory is
+ * released all at once by reset() or when the arena goes away.
+ * Unlike jtl::allocator, arena_allocator is stateful: two of them are equal
+ * only when they draw from the same arena
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jtl {
+
+class arena {
+ public:
+    static constexpr std::size_t Default_Chunk_Size = 64 * 1024;
+
+    explicit arena(std::size_t chunk_size = Default_Chunk_Size) noexcept
+            : chunk_size_{chunk_size} {}
+
+    arena(void *buffer, std::size_t size,
+            std::size_t chunk_size = Default_Chunk_Size) noexcept
+            : buffer_{static_cast<std::byte *>(buffer)},
+              buffer_size_{size},
+              cur_{buffer_},
+              end_{buffer_ + size},
+              chunk_size_{chunk_size} {}
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    ~arena() {
+        release_chunks();
+    }
+
+    [[nodiscard]] void *allocate(std::size_t bytes,
+            std::size_t alignment = alignof(std::max_align_t)) {
+        if (auto ptr = bump(bytes, alignment)) {
+            return ptr;
+        }
+        add_chunk(bytes, alignment);
+        return bump(bytes, alignment);
+    }
+
+    // Rewinds to the start of the caller buffer and gives the chained
+    // chunks back to the heap
+    void reset() noexcept {
+        release_chunks();
+        cur_ = buffer_;
+        end_ = buffer_ + buffer_size_;
+    }
+
+    // Number of heap chunks chained so far
+    [[nodiscard]] std::size_t chunks() const noexcept {
+        return num_chunks_;
+    }
+
+ private:
+    struct chunk {
+        chunk *next;
+    };
+
+    std::byte *buffer_{nullptr};
+    std::size_t buffer_size_{};
+    std::byte *cur_{nullptr};
+    std::byte *end_{nullptr};
+    std::size_t chunk_size_{};
+    chunk *chunks_{nullptr};
+    std::size_t num_chunks_{};
+
+    void *bump(std::size_t bytes, std::size_t alignment) noexcept {
+        if (cur_ == nullptr) {
+            return nullptr;
+        }
+        void *ptr = cur_;
+        auto space = static_cast<std::size_t>(end_ - cur_);
+        if (std::align(alignment, bytes, ptr, space) == nullptr) {
+            return nullptr;
+        }
+        cur_ = static_cast<std::byte *>(ptr) + bytes;
+        return ptr;
+    }
+
+    // Chunks grow geometrically so long-lived arenas chain few of them
+    void add_chunk(std::size_t bytes, std::size_t alignment) {
+        const auto payload = std::max(chunk_size_, bytes + alignment);
+        auto raw = static_cast<std::byte *>(
+                ::operator new(sizeof(chunk) + payload));
+        chunks_ = ::new (raw) chunk{chunks_};
+        ++num_chunks_;
+        cur_ = raw + sizeof(chunk);
+        end_ = cur_ + payload;
+        chunk_size_ *= 2;
+    }
+
+    void release_chunks() noexcept {
+        while (chunks_ != nullptr) {
+            ::operator delete(std::exchange(chunks_, chunks_->next));
+        }
+        num_chunks_ = 0;
+    }
+};
+
+template <typename T>
+class arena_allocator {
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    constexpr explicit arena_allocator(arena &resource) noexcept
+            : arena_{&resource} {}
+    constexpr arena_allocator(const arena_allocator &other) noexcept = default;
+    template <class U>
+    constexpr arena_allocator(const arena_allocator<U> &other) noexcept
+            : arena_{other.resource()} {}
+    constexpr ~arena_allocator() = default;
+
+    [[nodiscard]] T *allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+    constexpr void deallocate([[maybe_unused]] T *p,
+            [[maybe_unused]] size_type n = 0) noexcept {}
+
+    [[nodiscard]] constexpr arena *resource() const noexcept {
+        return arena_;
+    }
+
+    template <class U>
+    constexpr bool operator==(const arena_allocator<U> &other) const noexcept {
+        return arena_ == other.resource();
+    }
+
+ private:
+    arena *arena_;
+};
+
+}  // namespace jtl
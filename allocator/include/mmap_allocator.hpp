@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+/**
+ * @brief STL complaint allocator backed by anonymous memory mappings
+ * Requests of at least Threshold bytes get their own mapping, aligned and
+ * rounded up to 2 MiB and advised for transparent huge pages, and go back
+ * to the OS on deallocate. Smaller requests are served by jtl::allocator.
+ * With Populate set the whole mapping is faulted in up front, trading
+ * allocation time for a page-fault free first pass over the data.
+ * Like jtl::allocator, this one is stateless
+ */
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "allocator.hpp"
+
+namespace jtl {
+
+inline constexpr std::size_t Huge_Page_Size = std::size_t{2} << 20;
+
+template <typename T, std::size_t Threshold = Huge_Page_Size,
+        bool Populate = false>
+class mmap_allocator {
+    static_assert(alignof(T) <= Huge_Page_Size,
+            "mappings are only aligned to the huge page size");
+
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = mmap_allocator<U, Threshold, Populate>;
+    };
+
+    constexpr mmap_allocator() noexcept = default;
+    constexpr mmap_allocator(const mmap_allocator &other) noexcept = default;
+    template <class U>
+    constexpr mmap_allocator([[maybe_unused]] const mmap_allocator<U,
+            Threshold, Populate> &other) noexcept {}
+    constexpr ~mmap_allocator() = default;
+
+    [[nodiscard]] T *allocate(size_type n) {
+        if (!is_mapped(n)) {
+            return heap_.allocate(n);
+        }
+        return static_cast<T *>(map(mapping_size(n)));
+    }
+    void deallocate(T *p, size_type n) noexcept {
+        if (p == nullptr) {
+            return;
+        }
+        if (!is_mapped(n)) {
+            heap_.deallocate(p, n);
+        } else {
+            ::munmap(p, mapping_size(n));
+        }
+    }
+
+    // Resizes a block holding trivially relocatable elements. Mappings are
+    // grown or shrunk with mremap, which moves page table entries instead
+    // of copying the data, and stay on a huge page boundary
+    [[nodiscard]] T *reallocate(T *p, size_type old_n, size_type new_n)
+        requires(alignof(T) <= alignof(std::max_align_t)) {
+        if (!is_mapped(old_n) && !is_mapped(new_n)) {
+            return heap_.reallocate(p, old_n, new_n);
+        }
+        if (is_mapped(old_n) && is_mapped(new_n)) {
+            return remap(p, mapping_size(old_n), mapping_size(new_n));
+        }
+        auto nptr = allocate(new_n);
+        std::memcpy(static_cast<void *>(nptr), static_cast<const void *>(p),
+                std::min(old_n, new_n) * sizeof(T));
+        deallocate(p, old_n);
+        return nptr;
+    }
+
+    // True when a request of n elements gets its own mapping
+    [[nodiscard]] static constexpr bool is_mapped(size_type n) noexcept {
+        return n != 0 && n >= (Threshold + sizeof(T) - 1) / sizeof(T);
+    }
+
+    template <class U>
+    constexpr bool operator==([[maybe_unused]] const mmap_allocator<U,
+            Threshold, Populate> &other) const noexcept {
+        return true;
+    }
+
+ private:
+    [[no_unique_address]] allocator<T> heap_{};
+
+    static std::size_t mapping_size(size_type n) {
+        if (n > (std::numeric_limits<size_type>::max() - Huge_Page_Size) /
+                        sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return (n * sizeof(T) + Huge_Page_Size - 1) & ~(Huge_Page_Size - 1);
+    }
+
+    static void *map(std::size_t bytes) {
+        auto ptr = map_aligned(bytes);
+        advise(ptr, bytes);
+        if constexpr (Populate) {
+            prefault(ptr, bytes);
+        }
+        return ptr;
+    }
+
+    // Over-maps by one huge page and trims both ends so the mapping starts
+    // on a huge page boundary
+    static void *map_aligned(std::size_t bytes) {
+        auto raw = ::mmap(nullptr, bytes + Huge_Page_Size,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const auto addr = reinterpret_cast<std::uintptr_t>(raw);
+        const auto aligned =
+                (addr + Huge_Page_Size - 1) & ~(Huge_Page_Size - 1);
+        if (const auto head = aligned - addr; head > 0) {
+            ::munmap(raw, head);
+        }
+        if (const auto tail = Huge_Page_Size - (aligned - addr); tail > 0) {
+            ::munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    static T *remap(T *p, std::size_t old_bytes, std::size_t new_bytes) {
+        if (old_bytes == new_bytes) {
+            return p;
+        }
+        // Shrinking, or growing into free address space, keeps the start
+        auto ptr = ::mremap(p, old_bytes, new_bytes, 0);
+        if (ptr == MAP_FAILED) {
+            // Left alone mremap would move the pages to any page aligned
+            // address, they go over an aligned mapping reserved for them
+            auto target = map_aligned(new_bytes);
+            ptr = ::mremap(p, old_bytes, new_bytes,
+                    MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (ptr == MAP_FAILED) {
+                ::munmap(target, new_bytes);
+                throw std::bad_alloc();
+            }
+        }
+        if (new_bytes > old_bytes) {
+            advise(ptr, new_bytes);
+            if constexpr (Populate) {
+                prefault(static_cast<std::byte *>(ptr) + old_bytes,
+                        new_bytes - old_bytes);
+            }
+        }
+        return static_cast<T *>(ptr);
+    }
+
+    // Huge pages are a hint, the mapping is usable whether or not the
+    // kernel honors it
+    static void advise([[maybe_unused]] void *ptr,
+            [[maybe_unused]] std::size_t bytes) noexcept {
+#ifdef MADV_HUGEPAGE
+        ::madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+    }
+
+    static void prefault(void *ptr, std::size_t bytes) noexcept {
+#ifdef MADV_POPULATE_WRITE
+        if (::madvise(ptr, bytes, MADV_POPULATE_WRITE) == 0) {
+            return;
+        }
+#endif
+        // Writing back what was read faults the page in without changing it
+        auto bytes_ptr = static_cast<volatile std::byte *>(ptr);
+        for (std::size_t offset = 0; offset < bytes; offset += 4096) {
+            bytes_ptr[offset] = bytes_ptr[offset];
+        }
+    }
+};
+
+}  // namespace jtl
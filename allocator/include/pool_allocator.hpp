@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+/**
+ * @brief Fixed-size block pool and the STL complaint allocator on top of it
+ * The pool carves equally sized blocks out of contiguous pages and recycles
+ * freed blocks through an intrusive free list, so node based containers
+ * never go back to the heap once the pool is warm.
+ * Single object requests are served by the pool, array requests fall back
+ * to the heap. Copies and rebinds of a pool_allocator share a registry
+ * holding one pool per block size, so a container's node allocator
+ * compares equal to the allocator it was built from and draws from the
+ * same pools
+ */
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jtl {
+
+template <std::size_t Block_Size, std::size_t Block_Align>
+class block_pool {
+ public:
+    static constexpr std::size_t Default_Blocks_Per_Page = 256;
+
+    explicit block_pool(
+            std::size_t blocks_per_page = Default_Blocks_Per_Page) noexcept
+            : blocks_per_page_{blocks_per_page < 1 ? 1 : blocks_per_page} {}
+
+    block_pool(const block_pool &) = delete;
+    block_pool &operator=(const block_pool &) = delete;
+
+    ~block_pool() {
+        while (pages_ != nullptr) {
+            ::operator delete(std::exchange(pages_, pages_->next),
+                    std::align_val_t{alignof(block)});
+        }
+    }
+
+    [[nodiscard]] void *allocate() {
+        if (free_list_ != nullptr) {
+            return std::exchange(free_list_, free_list_->next);
+        }
+        if (cur_ == end_) {
+            add_page();
+        }
+        return cur_++;
+    }
+
+    void deallocate(void *ptr) noexcept {
+        free_list_ = ::new (ptr) block{free_list_};
+    }
+
+    [[nodiscard]] std::size_t pages() const noexcept {
+        return num_pages_;
+    }
+
+ private:
+    union block {
+        block *next;
+        alignas(Block_Align) std::byte storage[Block_Size];
+    };
+
+    std::size_t blocks_per_page_;
+    block *pages_{nullptr};
+    block *free_list_{nullptr};
+    block *cur_{nullptr};
+    block *end_{nullptr};
+    std::size_t num_pages_{};
+
+    // The first block of every page links the pages together
+    void add_page() {
+        auto page = static_cast<block *>(
+                ::operator new((blocks_per_page_ + 1) * sizeof(block),
+                        std::align_val_t{alignof(block)}));
+        pages_ = ::new (page) block{pages_};
+        ++num_pages_;
+        cur_ = page + 1;
+        end_ = cur_ + blocks_per_page_;
+    }
+};
+
+// Pools of every block geometry asked for by a family of pool_allocators,
+// created on first use and released with the last allocator of the family
+class pool_registry {
+ public:
+    explicit pool_registry(std::size_t blocks_per_page) noexcept
+            : blocks_per_page_{blocks_per_page} {}
+
+    pool_registry(const pool_registry &) = delete;
+    pool_registry &operator=(const pool_registry &) = delete;
+
+    template <std::size_t Block_Size, std::size_t Block_Align>
+    [[nodiscard]] block_pool<Block_Size, Block_Align> &pool() {
+        using pool_type = block_pool<Block_Size, Block_Align>;
+        for (const auto &entry : pools_) {
+            if (entry.size == Block_Size && entry.align == Block_Align) {
+                return *static_cast<pool_type *>(entry.pool.get());
+            }
+        }
+        auto pool = std::make_shared<pool_type>(blocks_per_page_);
+        pools_.push_back({Block_Size, Block_Align, pool});
+        return *pool;
+    }
+
+    [[nodiscard]] std::size_t blocks_per_page() const noexcept {
+        return blocks_per_page_;
+    }
+
+ private:
+    struct entry {
+        std::size_t size;
+        std::size_t align;
+        std::shared_ptr<void> pool;
+    };
+
+    std::size_t blocks_per_page_;
+    std::vector<entry> pools_;
+};
+
+template <typename T>
+class pool_allocator {
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pool_type = block_pool<sizeof(T), alignof(T)>;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    explicit pool_allocator(
+            std::size_t blocks_per_page = pool_type::Default_Blocks_Per_Page)
+            : registry_{std::make_shared<pool_registry>(blocks_per_page)},
+              pool_{&registry_->pool<sizeof(T), alignof(T)>()} {}
+    pool_allocator(const pool_allocator &other) noexcept = default;
+    // Blocks of another type may have another size, the rebound allocator
+    // takes the registry's pool for it
+    template <class U>
+    explicit pool_allocator(const pool_allocator<U> &other)
+            : registry_{other.registry_},
+              pool_{&registry_->template pool<sizeof(T), alignof(T)>()} {}
+    ~pool_allocator() = default;
+
+    [[nodiscard]] T *allocate(size_type n) {
+        if (n == 1) {
+            return static_cast<T *>(pool_->allocate());
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T *p, size_type n) noexcept {
+        if (n == 1) {
+            pool_->deallocate(p);
+        } else {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+    }
+
+    [[nodiscard]] std::size_t blocks_per_page() const noexcept {
+        return registry_->blocks_per_page();
+    }
+    [[nodiscard]] const pool_type &pool() const noexcept {
+        return *pool_;
+    }
+
+    template <class U>
+    bool operator==(const pool_allocator<U> &other) const noexcept {
+        return registry_ == other.registry_;
+    }
+
+ private:
+    template <class U>
+    friend class pool_allocator;
+
+    std::shared_ptr<pool_registry> registry_;
+    pool_type *pool_;
+};
+
+}  // namespace jtl
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+/**
+ * @brief STL complaint allocator counting what goes through another one
+ * Every tracking_allocator reports to a set of allocation_counters shared
+ * by its copies and rebinds, so a container and the nodes it allocates
+ * account into the same place. Counters are relaxed atomics: updating them
+ * costs a few uncontended RMWs, and a snapshot may mix values from
+ * allocations racing with it
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+
+namespace jtl {
+
+struct allocation_stats {
+    // Bucket i counts requests of [2^(i-1), 2^i) bytes, bucket 0 the empty
+    // ones
+    static constexpr std::size_t Histogram_Buckets = 65;
+
+    std::uint64_t allocations{};
+    std::uint64_t deallocations{};
+    std::uint64_t reallocations{};
+    std::uint64_t allocated_bytes{};
+    std::uint64_t live_bytes{};
+    std::uint64_t peak_bytes{};
+    std::array<std::uint64_t, Histogram_Buckets> histogram{};
+};
+
+class allocation_counters {
+ public:
+    void on_allocate(std::size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        histogram_[std::bit_width(bytes)].fetch_add(
+                1, std::memory_order_relaxed);
+        add_live(bytes);
+    }
+
+    void on_deallocate(std::size_t bytes) noexcept {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    // A block resized in place counts as one reallocation, not as a new
+    // allocation
+    void on_reallocate(std::size_t old_bytes, std::size_t new_bytes) noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+        if (new_bytes > old_bytes) {
+            allocated_bytes_.fetch_add(
+                    new_bytes - old_bytes, std::memory_order_relaxed);
+            add_live(new_bytes - old_bytes);
+        } else {
+            live_bytes_.fetch_sub(
+                    old_bytes - new_bytes, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] allocation_stats snapshot() const noexcept {
+        allocation_stats stats;
+        stats.allocations = allocations_.load(std::memory_order_relaxed);
+        stats.deallocations = deallocations_.load(std::memory_order_relaxed);
+        stats.reallocations = reallocations_.load(std::memory_order_relaxed);
+        stats.allocated_bytes =
+                allocated_bytes_.load(std::memory_order_relaxed);
+        stats.live_bytes = live_bytes_.load(std::memory_order_relaxed);
+        stats.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < stats.histogram.size(); ++i) {
+            stats.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    // Starts a new measurement window, memory still alive keeps counting
+    // as live and becomes the new peak
+    void reset() noexcept {
+        allocations_.store(0, std::memory_order_relaxed);
+        deallocations_.store(0, std::memory_order_relaxed);
+        reallocations_.store(0, std::memory_order_relaxed);
+        allocated_bytes_.store(0, std::memory_order_relaxed);
+        peak_bytes_.store(live_bytes_.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        for (auto &bucket : histogram_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+ private:
+    using counter = std::atomic<std::uint64_t>;
+
+    counter allocations_{};
+    counter deallocations_{};
+    counter reallocations_{};
+    counter allocated_bytes_{};
+    counter live_bytes_{};
+    counter peak_bytes_{};
+    std::array<counter, allocation_stats::Histogram_Buckets> histogram_{};
+
+    void add_live(std::size_t bytes) noexcept {
+        const auto live =
+                live_bytes_.fetch_add(bytes, std::memory_order_relaxed) +
+                bytes;
+        auto peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (live > peak &&
+                !peak_bytes_.compare_exchange_weak(
+                        peak, live, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+template <typename T, typename Inner = allocator<T>>
+class tracking_allocator {
+    using inner_traits = std::allocator_traits<Inner>;
+
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = typename inner_traits::pointer;
+    using inner_allocator_type = Inner;
+    // Statistics follow the storage they describe
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = tracking_allocator<U,
+                typename inner_traits::template rebind_alloc<U>>;
+    };
+
+    tracking_allocator()
+            : counters_{std::make_shared<allocation_counters>()} {}
+    explicit tracking_allocator(std::shared_ptr<allocation_counters> counters,
+            const Inner &inner = Inner())
+            : counters_{std::move(counters)}, inner_{inner} {}
+    tracking_allocator(const tracking_allocator &other) noexcept = default;
+    template <class U, class Inner_U>
+    tracking_allocator(const tracking_allocator<U, Inner_U> &other)
+            : counters_{other.counters()}, inner_{other.inner()} {}
+    ~tracking_allocator() = default;
+
+    [[nodiscard]] pointer allocate(size_type n) {
+        auto ptr = inner_traits::allocate(inner_, n);
+        counters_->on_allocate(n * sizeof(T));
+        return ptr;
+    }
+    void deallocate(pointer p, size_type n) {
+        counters_->on_deallocate(n * sizeof(T));
+        inner_traits::deallocate(inner_, p, n);
+    }
+
+    // Only offered when the wrapped allocator can resize in place
+    [[nodiscard]] pointer reallocate(
+            pointer p, size_type old_n, size_type new_n)
+        requires requires(Inner inner, pointer ptr, size_type n) {
+            inner.reallocate(ptr, n, n);
+        }
+    {
+        auto ptr = inner_.reallocate(p, old_n, new_n);
+        counters_->on_reallocate(old_n * sizeof(T), new_n * sizeof(T));
+        return ptr;
+    }
+
+    [[nodiscard]] allocation_stats stats() const noexcept {
+        return counters_->snapshot();
+    }
+    void reset_stats() const noexcept {
+        counters_->reset();
+    }
+
+    [[nodiscard]] const std::shared_ptr<allocation_counters> &counters()
+            const noexcept {
+        return counters_;
+    }
+    [[nodiscard]] const Inner &inner() const noexcept {
+        return inner_;
+    }
+
+    template <class U, class Inner_U>
+    bool operator==(
+            const tracking_allocator<U, Inner_U> &other) const noexcept {
+        return counters_ == other.counters() && inner_ == other.inner();
+    }
+
+ private:
+    std::shared_ptr<allocation_counters> counters_;
+    [[no_unique_address]] Inner inner_{};
+};
+
+}  // namespace jtl
@@ -2,7 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 struct AllocatorTest : testing::Test {
@@ -40,6 +42,45 @@ TEST_F(AllocatorTest, ConstexprAllocDealoc) {
     EXPECT_TRUE(true);
 }
 
+TEST_F(AllocatorTest, ConstructDestroy) {
+    struct NoDefault {
+        std::string value;
+        explicit NoDefault(std::string v) : value{std::move(v)} {}
+    };
+    jtl::allocator<NoDefault> al;
+    auto ptr = al.allocate(2);
+    al.construct(ptr, "jtl");
+    al.construct(ptr + 1, std::string(64, 'x'));
+    const auto res = ptr[0].value == "jtl" && ptr[1].value.size() == 64;
+    al.destroy(ptr);
+    al.destroy(ptr + 1);
+    al.deallocate(ptr, 2);
+    EXPECT_TRUE(res);
+}
+
+TEST_F(AllocatorTest, Reallocate) {
+    auto iptr = alloc->allocate(4);
+    for (auto i = 0; i < 4; ++i) {
+        iptr[i] = i;
+    }
+    iptr = alloc->reallocate(iptr, 4, 1 << 16);
+    iptr[(1 << 16) - 1] = 42;
+    const auto res = iptr[3] == 3 && iptr[(1 << 16) - 1] == 42;
+    alloc->deallocate(iptr, 1 << 16);
+    EXPECT_TRUE(res);
+}
+
+TEST_F(AllocatorTest, OverAligned) {
+    struct alignas(64) Line {
+        char bytes[64];
+    };
+    jtl::allocator<Line> al;
+    auto ptr = al.allocate(3);
+    const auto res = reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0;
+    al.deallocate(ptr, 3);
+    EXPECT_TRUE(res);
+}
+
 TEST_F(AllocatorTest, ContainerAlloc) {
     std::vector<int> v{1, 2, 3, 4};
     std::vector<int, jtl::allocator<int>> valloc{1, 2, 3, 4};
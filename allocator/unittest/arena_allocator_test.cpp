@@ -0,0 +1,76 @@
+#include "arena_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct ArenaAllocatorTest : testing::Test {
+    alignas(std::max_align_t) std::array<std::byte, 1024> buffer{};
+};
+
+TEST_F(ArenaAllocatorTest, CallerBuffer) {
+    jtl::arena arena{buffer.data(), buffer.size()};
+    jtl::arena_allocator<std::uint64_t> alloc{arena};
+    auto ptr = alloc.allocate(16);
+    auto ptr2 = alloc.allocate(16);
+    alloc.deallocate(ptr, 16);
+    const auto in_buffer = [&](const auto *p) {
+        return reinterpret_cast<const std::byte *>(p) >= buffer.data() &&
+                reinterpret_cast<const std::byte *>(p) <
+                buffer.data() + buffer.size();
+    };
+    EXPECT_TRUE(in_buffer(ptr) && in_buffer(ptr2) && ptr2 == ptr + 16);
+    EXPECT_EQ(arena.chunks(), 0);
+}
+
+TEST_F(ArenaAllocatorTest, Alignment) {
+    jtl::arena arena{buffer.data(), buffer.size()};
+    [[maybe_unused]] auto byte = arena.allocate(1, 1);
+    auto ptr = arena.allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % 64, 0);
+}
+
+TEST_F(ArenaAllocatorTest, ChainedChunksAndReset) {
+    jtl::arena arena{buffer.data(), buffer.size(), 256};
+    jtl::arena_allocator<std::uint64_t> alloc{arena};
+    [[maybe_unused]] auto ptr = alloc.allocate(100);
+    [[maybe_unused]] auto ptr2 = alloc.allocate(100);
+    [[maybe_unused]] auto ptr3 = alloc.allocate(1000);
+    EXPECT_EQ(arena.chunks(), 2);
+
+    arena.reset();
+    EXPECT_EQ(arena.chunks(), 0);
+    EXPECT_EQ(reinterpret_cast<std::byte *>(alloc.allocate(1)), buffer.data());
+}
+
+TEST_F(ArenaAllocatorTest, HeapOnly) {
+    jtl::arena arena;
+    auto ptr = arena.allocate(64);
+    EXPECT_TRUE(ptr != nullptr && arena.chunks() == 1);
+}
+
+TEST_F(ArenaAllocatorTest, Equality) {
+    jtl::arena arena;
+    jtl::arena arena2;
+    jtl::arena_allocator<int> alloc{arena};
+    jtl::arena_allocator<char> rebound{alloc};
+    EXPECT_TRUE(alloc == rebound &&
+            alloc != jtl::arena_allocator<int>{arena2});
+}
+
+TEST_F(ArenaAllocatorTest, ContainerAlloc) {
+    jtl::arena arena{buffer.data(), buffer.size()};
+    std::vector<int, jtl::arena_allocator<int>> vec{
+            jtl::arena_allocator<int>{arena}};
+    for (auto i = 0; i < 64; ++i) {
+        vec.push_back(i);
+    }
+    EXPECT_TRUE(vec.size() == 64 && vec[63] == 63 && arena.chunks() == 0);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
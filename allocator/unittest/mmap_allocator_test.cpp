@@ -0,0 +1,91 @@
+#include "mmap_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using mapped_alloc_t = jtl::mmap_allocator<std::uint64_t, 1 << 16>;
+
+constexpr auto Mapped_Elements = std::size_t{1} << 13;
+
+bool huge_page_aligned(const void *ptr) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % jtl::Huge_Page_Size == 0;
+}
+
+TEST(MmapAllocatorTest, HeapFallback) {
+    mapped_alloc_t alloc;
+    auto ptr = alloc.allocate(16);
+    ptr[15] = 42;
+    const auto res = !mapped_alloc_t::is_mapped(16) && ptr[15] == 42;
+    alloc.deallocate(ptr, 16);
+    EXPECT_TRUE(res);
+}
+
+TEST(MmapAllocatorTest, HugePageAligned) {
+    mapped_alloc_t alloc;
+    auto ptr = alloc.allocate(Mapped_Elements);
+    ptr[0] = 1;
+    ptr[Mapped_Elements - 1] = 2;
+    const auto res = mapped_alloc_t::is_mapped(Mapped_Elements) &&
+            huge_page_aligned(ptr) && ptr[Mapped_Elements - 1] == 2;
+    alloc.deallocate(ptr, Mapped_Elements);
+    EXPECT_TRUE(res);
+}
+
+TEST(MmapAllocatorTest, Populate) {
+    jtl::mmap_allocator<std::uint64_t, 1 << 16, true> alloc;
+    auto ptr = alloc.allocate(Mapped_Elements);
+    const auto res = huge_page_aligned(ptr) && ptr[Mapped_Elements / 2] == 0;
+    alloc.deallocate(ptr, Mapped_Elements);
+    EXPECT_TRUE(res);
+}
+
+TEST(MmapAllocatorTest, Reallocate) {
+    mapped_alloc_t alloc;
+    auto ptr = alloc.allocate(16);
+    ptr[15] = 15;
+    // Heap to mapping, then mapping to a bigger mapping
+    ptr = alloc.reallocate(ptr, 16, Mapped_Elements);
+    ptr[Mapped_Elements - 1] = 42;
+    ptr = alloc.reallocate(ptr, Mapped_Elements, 64 * Mapped_Elements);
+    ptr[64 * Mapped_Elements - 1] = 43;
+    const auto res = ptr[15] == 15 && ptr[Mapped_Elements - 1] == 42 &&
+            ptr[64 * Mapped_Elements - 1] == 43;
+    alloc.deallocate(ptr, 64 * Mapped_Elements);
+    EXPECT_TRUE(res);
+}
+
+TEST(MmapAllocatorTest, ReallocateMovedStaysAligned) {
+    mapped_alloc_t alloc;
+    auto ptr = alloc.allocate(Mapped_Elements);
+    ptr[Mapped_Elements - 1] = 42;
+    // A page right after the mapping keeps it from growing in place
+    const auto guard = ::mmap(ptr + jtl::Huge_Page_Size / sizeof(*ptr), 4096,
+            PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1,
+            0);
+    ASSERT_NE(guard, MAP_FAILED);
+    const auto old = ptr;
+    ptr = alloc.reallocate(ptr, Mapped_Elements, 64 * Mapped_Elements);
+    ptr[64 * Mapped_Elements - 1] = 43;
+    const auto res = ptr != old && huge_page_aligned(ptr) &&
+            ptr[Mapped_Elements - 1] == 42;
+    alloc.deallocate(ptr, 64 * Mapped_Elements);
+    ::munmap(guard, 4096);
+    EXPECT_TRUE(res);
+}
+
+TEST(MmapAllocatorTest, ContainerAlloc) {
+    std::vector<std::uint64_t, mapped_alloc_t> vec;
+    for (std::uint64_t i = 0; i < 4 * Mapped_Elements; ++i) {
+        vec.push_back(i);
+    }
+    EXPECT_TRUE(vec.size() == 4 * Mapped_Elements &&
+            vec.back() == 4 * Mapped_Elements - 1 &&
+            huge_page_aligned(vec.data()));
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
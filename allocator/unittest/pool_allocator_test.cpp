@@ -0,0 +1,80 @@
+#include "pool_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <set>
+
+struct PoolAllocatorTest : testing::Test {
+    jtl::pool_allocator<std::uint64_t> alloc{4};
+};
+
+TEST_F(PoolAllocatorTest, ContiguousBlocks) {
+    auto ptr = alloc.allocate(1);
+    auto ptr2 = alloc.allocate(1);
+    EXPECT_TRUE(ptr2 == ptr + 1 && alloc.pool().pages() == 1);
+    alloc.deallocate(ptr, 1);
+    alloc.deallocate(ptr2, 1);
+}
+
+TEST_F(PoolAllocatorTest, FreeListReuse) {
+    auto ptr = alloc.allocate(1);
+    alloc.deallocate(ptr, 1);
+    EXPECT_EQ(alloc.allocate(1), ptr);
+}
+
+TEST_F(PoolAllocatorTest, NewPages) {
+    std::set<std::uint64_t *> blocks;
+    for (auto i = 0; i < 9; ++i) {
+        blocks.insert(alloc.allocate(1));
+    }
+    EXPECT_TRUE(blocks.size() == 9 && alloc.pool().pages() == 3);
+}
+
+TEST_F(PoolAllocatorTest, ArrayFallback) {
+    auto ptr = alloc.allocate(16);
+    ptr[15] = 42;
+    alloc.deallocate(ptr, 16);
+    EXPECT_EQ(alloc.pool().pages(), 0);
+}
+
+TEST_F(PoolAllocatorTest, Equality) {
+    const auto copy{alloc};
+    const jtl::pool_allocator<std::uint32_t> rebound{alloc};
+    EXPECT_TRUE(copy == alloc && alloc != jtl::pool_allocator<std::uint64_t>{} &&
+            rebound.blocks_per_page() == 4);
+    // A(B(a)) == a, and the round trip lands on the same pool
+    const jtl::pool_allocator<std::uint64_t> back{rebound};
+    EXPECT_TRUE(rebound == alloc && back == alloc &&
+            &back.pool() == &alloc.pool());
+}
+
+TEST_F(PoolAllocatorTest, RebindSharesPools) {
+    // Same block geometry, same pool
+    jtl::pool_allocator<double> same{alloc};
+    auto ptr = alloc.allocate(1);
+    same.deallocate(reinterpret_cast<double *>(ptr), 1);
+    EXPECT_EQ(static_cast<void *>(same.allocate(1)), ptr);
+    // Other sizes get their own pool from the shared registry
+    jtl::pool_allocator<std::uint32_t> small{alloc};
+    small.deallocate(small.allocate(1), 1);
+    EXPECT_TRUE(small.pool().pages() == 1 && alloc.pool().pages() == 1);
+}
+
+TEST_F(PoolAllocatorTest, ContainerAlloc) {
+    std::list<int, jtl::pool_allocator<int>> l;
+    for (auto i = 0; i < 1000; ++i) {
+        l.push_back(i);
+    }
+    l.clear();
+    for (auto i = 0; i < 1000; ++i) {
+        l.push_back(i);
+    }
+    EXPECT_TRUE(l.size() == 1000 && l.back() == 999);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
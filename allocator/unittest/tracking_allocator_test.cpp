@@ -0,0 +1,88 @@
+#include "tracking_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include "pool_allocator.hpp"
+
+struct TrackingAllocatorTest : testing::Test {
+    jtl::tracking_allocator<std::uint64_t> alloc;
+};
+
+TEST_F(TrackingAllocatorTest, Counters) {
+    auto ptr = alloc.allocate(4);
+    auto ptr2 = alloc.allocate(100);
+    alloc.deallocate(ptr, 4);
+    const auto stats = alloc.stats();
+    alloc.deallocate(ptr2, 100);
+    EXPECT_TRUE(stats.allocations == 2 && stats.deallocations == 1 &&
+            stats.allocated_bytes == 832 && stats.live_bytes == 800 &&
+            stats.peak_bytes == 832);
+    EXPECT_TRUE(stats.histogram[6] == 1 && stats.histogram[10] == 1);
+    EXPECT_EQ(alloc.stats().live_bytes, 0);
+}
+
+TEST_F(TrackingAllocatorTest, Reallocate) {
+    auto ptr = alloc.allocate(4);
+    ptr = alloc.reallocate(ptr, 4, 8);
+    const auto stats = alloc.stats();
+    alloc.deallocate(ptr, 8);
+    EXPECT_TRUE(stats.allocations == 1 && stats.reallocations == 1 &&
+            stats.live_bytes == 64 && stats.peak_bytes == 64);
+}
+
+TEST_F(TrackingAllocatorTest, Reset) {
+    auto ptr = alloc.allocate(2);
+    alloc.deallocate(alloc.allocate(8), 8);
+    alloc.reset_stats();
+    const auto stats = alloc.stats();
+    alloc.deallocate(ptr, 2);
+    EXPECT_TRUE(stats.allocations == 0 && stats.deallocations == 0 &&
+            stats.live_bytes == 16 && stats.peak_bytes == 16);
+}
+
+TEST_F(TrackingAllocatorTest, SharedByRebinds) {
+    const jtl::tracking_allocator<char> rebound{alloc};
+    std::list<int, jtl::tracking_allocator<int>> l{
+            jtl::tracking_allocator<int>{alloc}};
+    l.push_back(1);
+    l.push_back(2);
+    EXPECT_TRUE(rebound == alloc && alloc.stats().allocations == 2 &&
+            alloc != jtl::tracking_allocator<std::uint64_t>{});
+}
+
+TEST_F(TrackingAllocatorTest, InnerPool) {
+    jtl::tracking_allocator<int, jtl::pool_allocator<int>> pool_alloc{
+            std::make_shared<jtl::allocation_counters>(),
+            jtl::pool_allocator<int>{4}};
+    auto ptr = pool_alloc.allocate(1);
+    pool_alloc.deallocate(ptr, 1);
+    EXPECT_TRUE(pool_alloc.stats().allocations == 1 &&
+            pool_alloc.inner().pool().pages() == 1);
+}
+
+TEST_F(TrackingAllocatorTest, Threads) {
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; ++t) {
+        threads.emplace_back([alloc = alloc]() mutable {
+            for (auto i = 0; i < 1000; ++i) {
+                alloc.deallocate(alloc.allocate(1), 1);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto stats = alloc.stats();
+    EXPECT_TRUE(stats.allocations == 4000 && stats.deallocations == 4000 &&
+            stats.live_bytes == 0);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,290 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bit_kernels.hpp"
+#include "bitset.hpp"
+#include "layout.hpp"
+#include "packed_vector.hpp"
+#include "rank_select.hpp"
+
+// What jtl::concat used to do for keys wider than 64 bits
+template <typename... Bitsets>
+static auto string_concat(const Bitsets &...bitsets) {
+    constexpr auto Size = (Bitsets{}.size() + ...);
+    std::string bs_str;
+    ((bs_str += bitsets.to_string()), ...);
+    return std::bitset<Size>{bs_str};
+}
+
+// 128, 256 and 512-bit lookup keys made of header fields
+template <std::size_t Field_Bits, bool Words>
+static void BM_ConcatKey(benchmark::State &state) {
+    std::bitset<Field_Bits> f1{0x0123456789abcdef};
+    std::bitset<Field_Bits / 2> f2{0xfedcba9876543210};
+    std::bitset<Field_Bits / 4> f3{0x5555};
+    std::bitset<Field_Bits / 4> f4{0xaaaa};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(f1);
+        if constexpr (Words) {
+            benchmark::DoNotOptimize(jtl::concat(f1, f2, f3, f4));
+        } else {
+            benchmark::DoNotOptimize(string_concat(f1, f2, f3, f4));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ConcatKey, 64, false);
+BENCHMARK_TEMPLATE(BM_ConcatKey, 64, true);
+BENCHMARK_TEMPLATE(BM_ConcatKey, 128, false);
+BENCHMARK_TEMPLATE(BM_ConcatKey, 128, true);
+BENCHMARK_TEMPLATE(BM_ConcatKey, 256, false);
+BENCHMARK_TEMPLATE(BM_ConcatKey, 256, true);
+
+// What jtl::split used to do for sources wider than 64 bits
+template <std::size_t N, typename Bitset, typename... Bitsets>
+static void string_split(
+        const std::bitset<N> &bs, Bitset &bs1, Bitsets &...bitsets) {
+    bs1 = Bitset{bs.to_string().substr(0, bs1.size())};
+    if constexpr (sizeof...(bitsets) > 0) {
+        constexpr auto Rest = N - Bitset{}.size();
+        string_split(std::bitset<Rest>{bs.to_string().substr(bs1.size())},
+                bitsets...);
+    }
+}
+
+// 256-bit header cut into 10 fields
+template <bool Words>
+static void BM_SplitHeader(benchmark::State &state) {
+    std::bitset<256> header{0x0123456789abcdef};
+    header <<= 100;
+    header |= std::bitset<256>{0xfedcba9876543210};
+    std::bitset<4> f1;
+    std::bitset<4> f2;
+    std::bitset<8> f3;
+    std::bitset<16> f4;
+    std::bitset<16> f5;
+    std::bitset<16> f6;
+    std::bitset<8> f7;
+    std::bitset<8> f8;
+    std::bitset<48> f9;
+    std::bitset<128> f10;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(header);
+        if constexpr (Words) {
+            jtl::split(header, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+        } else {
+            string_split(header, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+        }
+        benchmark::DoNotOptimize(f10);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_SplitHeader, false);
+BENCHMARK_TEMPLATE(BM_SplitHeader, true);
+
+// What jtl::range used to do for bitsets of up to 64 bits
+template <std::size_t N>
+static auto loop_range(const std::bitset<N> &bs, const std::uint64_t offset,
+        const std::uint64_t count) {
+    std::uint64_t bs_uint{};
+    for (auto idx = offset; idx < offset + count; ++idx) {
+        bs_uint |= std::uint64_t{bs[idx]} << (idx - offset);
+    }
+    return std::bitset<N>{bs_uint};
+}
+
+// IPv4-like fields pulled out of a 64-bit word, the parser's inner loop
+template <bool Shift>
+static void BM_RangeFields(benchmark::State &state) {
+    std::bitset<64> word{0x4500'0054'1c46'4000};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(word);
+        if constexpr (Shift) {
+            benchmark::DoNotOptimize(jtl::range(word, 60, 4));
+            benchmark::DoNotOptimize(jtl::range(word, 32, 16));
+            benchmark::DoNotOptimize(jtl::range(word, 0, 13));
+        } else {
+            benchmark::DoNotOptimize(loop_range(word, 60, 4));
+            benchmark::DoNotOptimize(loop_range(word, 32, 16));
+            benchmark::DoNotOptimize(loop_range(word, 0, 13));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_RangeFields, false);
+BENCHMARK_TEMPLATE(BM_RangeFields, true);
+
+// Non-contiguous flags, BMI2 when the CPU has it
+template <bool Bits>
+static void BM_GatherFlags(benchmark::State &state) {
+    constexpr std::uint64_t Mask = 0xe000'0000'00f0'0f01;
+    std::uint64_t value{0x4500'0054'1c46'4000};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(value);
+        if constexpr (Bits) {
+            benchmark::DoNotOptimize(jtl::extract_bits(value, Mask));
+        } else {
+            benchmark::DoNotOptimize(jtl::pext_portable(value, Mask));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_GatherFlags, false);
+BENCHMARK_TEMPLATE(BM_GatherFlags, true);
+
+using ipv4 = jtl::layout<jtl::field<"ver", 4>, jtl::field<"ihl", 4>,
+        jtl::field<"tos", 8>, jtl::field<"len", 16>, jtl::field<"id", 16>,
+        jtl::field<"flags", 3>, jtl::field<"frag", 13>, jtl::field<"ttl", 8>,
+        jtl::field<"proto", 8>, jtl::field<"csum", 16>,
+        jtl::field<"src", 32>, jtl::field<"dst", 32>>;
+
+// IPv4 header parsed from bytes, either through a bitset of the whole
+// header cut with jtl::split or straight from the buffer
+template <bool Layout>
+static void BM_ParseIpv4(benchmark::State &state) {
+    std::array<std::byte, ipv4::Size_Bytes> packet{};
+    for (std::size_t i = 0; i < packet.size(); ++i) {
+        packet[i] = static_cast<std::byte>(0x45 + 29 * i);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packet);
+        if constexpr (Layout) {
+            benchmark::DoNotOptimize(ipv4::parse(packet));
+        } else {
+            std::bitset<160> header{};
+            for (const auto byte : packet) {
+                header <<= 8;
+                header |= std::bitset<160>{std::to_integer<unsigned>(byte)};
+            }
+            ipv4::value_type fields;
+            std::apply([&](auto &...f) { jtl::split(header, f...); }, fields);
+            benchmark::DoNotOptimize(fields);
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ParseIpv4, false);
+BENCHMARK_TEMPLATE(BM_ParseIpv4, true);
+
+// Random queries over 2^28 bits, half of them set
+static const jtl::rank_select_bitvector &random_bitvector() {
+    static const auto bv = [] {
+        std::mt19937_64 gen{1};
+        std::vector<std::uint64_t> words(std::size_t{1} << 22);
+        for (auto &word : words) {
+            word = gen();
+        }
+        return jtl::rank_select_bitvector{words, words.size() * 64};
+    }();
+    return bv;
+}
+
+static void BM_Rank1(benchmark::State &state) {
+    const auto &bv = random_bitvector();
+    std::uint64_t pos{};
+    for (auto _ : state) {
+        pos = (pos * 0x5851f42d4c957f2d + 1442695040888963407) % bv.size();
+        benchmark::DoNotOptimize(bv.rank1(pos));
+    }
+}
+
+static void BM_Select1(benchmark::State &state) {
+    const auto &bv = random_bitvector();
+    std::uint64_t k{};
+    for (auto _ : state) {
+        k = (k * 0x5851f42d4c957f2d + 1442695040888963407) % bv.count();
+        benchmark::DoNotOptimize(bv.select1(k));
+    }
+}
+
+BENCHMARK(BM_Rank1);
+BENCHMARK(BM_Select1);
+
+// 1 MiB bitmaps intersected a word at a time the way std::bitset does it
+// and through the kernels at each level
+static void BM_Intersect(benchmark::State &state) {
+    const auto level = static_cast<jtl::simd_level>(state.range(0));
+    if (level > jtl::Simd_Level) {
+        state.SkipWithError("level not supported");
+        return;
+    }
+    std::mt19937_64 gen{3};
+    std::vector<std::uint64_t> a(std::size_t{1} << 17);
+    std::vector<std::uint64_t> b(a.size());
+    std::vector<std::uint64_t> dst(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = gen();
+        b[i] = gen();
+    }
+    for (auto _ : state) {
+        jtl::combine_words<jtl::bit_op::and_op>(
+                level, dst.data(), a.data(), b.data(), dst.size());
+        benchmark::DoNotOptimize(jtl::count_ones_words(
+                level, dst.data(), dst.size()));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(
+            state.iterations() * a.size() * sizeof(std::uint64_t) * 2));
+}
+
+BENCHMARK(BM_Intersect)->DenseRange(0, 3);
+
+// Random increments of 2^24 12-bit counters held as uint32_t and packed
+template <bool Packed>
+static void BM_BumpCounters(benchmark::State &state) {
+    constexpr std::size_t Count = std::size_t{1} << 24;
+    std::conditional_t<Packed, jtl::packed_vector<12>,
+            std::vector<std::uint32_t>>
+            counters(Count);
+    std::uint64_t pos{};
+    for (auto _ : state) {
+        pos = (pos * 0x5851f42d4c957f2d + 1442695040888963407);
+        auto &&counter = counters[(pos >> 20) % Count];
+        counter = (counter + 1) & 0xfff;
+    }
+    benchmark::DoNotOptimize(counters[0]);
+}
+
+BENCHMARK_TEMPLATE(BM_BumpCounters, false);
+BENCHMARK_TEMPLATE(BM_BumpCounters, true);
+
+// Sum of 2^20 12-bit codes read one by one and in runs of 256
+template <bool Bulk>
+static void BM_SumCodes(benchmark::State &state) {
+    std::mt19937_64 gen{4};
+    jtl::packed_vector<12> codes;
+    for (std::size_t i = 0; i < (std::size_t{1} << 20); ++i) {
+        codes.push_back(gen());
+    }
+    std::array<std::uint16_t, 256> run{};
+    for (auto _ : state) {
+        std::uint64_t sum{};
+        if constexpr (Bulk) {
+            for (std::size_t i = 0; i < codes.size(); i += run.size()) {
+                codes.get(i, std::span{run});
+                for (const auto code : run) {
+                    sum += code;
+                }
+            }
+        } else {
+            for (std::size_t i = 0; i < codes.size(); ++i) {
+                sum += std::as_const(codes)[i];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_SumCodes, false);
+BENCHMARK_TEMPLATE(BM_SumCodes, true);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Bulk kernels over arrays of 64-bit words
+ *  AND, OR, XOR, ANDNOT, popcount, any/none and find-first-set, each
+ *  with a scalar version and, on x86-64, SSE2, AVX2 and AVX-512 ones.
+ *  The vector versions are compiled through target attributes, so the
+ *  header builds without any -m flag, and the widest level the CPU and
+ *  the OS support is picked once on CPUID. Every *_words function also
+ *  takes the level explicitly, which the tests use to cover each path
+ */
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+enum class simd_level { scalar, sse2, avx2, avx512 };
+
+enum class bit_op { and_op, or_op, xor_op, andnot_op };
+
+inline simd_level detect_simd_level() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return simd_level::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return simd_level::avx2;
+    }
+    return simd_level::sse2;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+inline const simd_level Simd_Level = detect_simd_level();
+
+template <bit_op Op>
+constexpr std::uint64_t apply_op(const std::uint64_t a, const std::uint64_t b) {
+    if constexpr (Op == bit_op::and_op) {
+        return a & b;
+    } else if constexpr (Op == bit_op::or_op) {
+        return a | b;
+    } else if constexpr (Op == bit_op::xor_op) {
+        return a ^ b;
+    } else {
+        return a & ~b;
+    }
+}
+
+template <bit_op Op>
+inline void combine_scalar(std::uint64_t *dst, const std::uint64_t *a,
+        const std::uint64_t *b, const std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = apply_op<Op>(a[i], b[i]);
+    }
+}
+
+// Index of the first word that isn't zero, count when there is none
+inline std::size_t first_word_scalar(
+        const std::uint64_t *words, const std::size_t count) {
+    std::size_t i{};
+    while (i < count && words[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(__x86_64__)
+// dst may alias a or b, every vector is loaded before it is stored
+template <bit_op Op>
+inline void combine_sse2(std::uint64_t *dst, const std::uint64_t *a,
+        const std::uint64_t *b, const std::size_t count) {
+    std::size_t i{};
+    for (; i + 2 <= count; i += 2) {
+        const auto x =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const auto y =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i r;
+        if constexpr (Op == bit_op::and_op) {
+            r = _mm_and_si128(x, y);
+        } else if constexpr (Op == bit_op::or_op) {
+            r = _mm_or_si128(x, y);
+        } else if constexpr (Op == bit_op::xor_op) {
+            r = _mm_xor_si128(x, y);
+        } else {
+            r = _mm_andnot_si128(y, x);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), r);
+    }
+    combine_scalar<Op>(dst + i, a + i, b + i, count - i);
+}
+
+template <bit_op Op>
+__attribute__((target("avx2"))) inline void combine_avx2(std::uint64_t *dst,
+        const std::uint64_t *a, const std::uint64_t *b,
+        const std::size_t count) {
+    std::size_t i{};
+    for (; i + 4 <= count; i += 4) {
+        const auto x =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const auto y =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i r;
+        if constexpr (Op == bit_op::and_op) {
+            r = _mm256_and_si256(x, y);
+        } else if constexpr (Op == bit_op::or_op) {
+            r = _mm256_or_si256(x, y);
+        } else if constexpr (Op == bit_op::xor_op) {
+            r = _mm256_xor_si256(x, y);
+        } else {
+            r = _mm256_andnot_si256(y, x);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+    }
+    combine_sse2<Op>(dst + i, a + i, b + i, count - i);
+}
+
+template <bit_op Op>
+__attribute__((target("avx512f"))) inline void combine_avx512(
+        std::uint64_t *dst, const std::uint64_t *a, const std::uint64_t *b,
+        const std::size_t count) {
+    std::size_t i{};
+    for (; i + 8 <= count; i += 8) {
+        const auto x = _mm512_loadu_si512(a + i);
+        const auto y = _mm512_loadu_si512(b + i);
+        __m512i r;
+        if constexpr (Op == bit_op::and_op) {
+            r = _mm512_and_si512(x, y);
+        } else if constexpr (Op == bit_op::or_op) {
+            r = _mm512_or_si512(x, y);
+        } else if constexpr (Op == bit_op::xor_op) {
+            r = _mm512_xor_si512(x, y);
+        } else {
+            r = _mm512_andnot_si512(y, x);
+        }
+        _mm512_storeu_si512(dst + i, r);
+    }
+    combine_avx2<Op>(dst + i, a + i, b + i, count - i);
+}
+
+// Nibble lookup through vpshufb, byte counts summed per lane with vpsadbw
+__attribute__((target("avx2"))) inline std::size_t count_ones_avx2(
+        const std::uint64_t *words, const std::size_t count) {
+    const auto lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3,
+            2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const auto nibble = _mm256_set1_epi8(0x0f);
+    auto acc = _mm256_setzero_si256();
+    std::size_t i{};
+    for (; i + 4 <= count; i += 4) {
+        const auto v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(words + i));
+        const auto lo = _mm256_and_si256(v, nibble);
+        const auto hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        const auto bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(
+                acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+    return static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] +
+                   lanes[3]) +
+            popcount_words(words + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline std::size_t
+count_ones_avx512(const std::uint64_t *words, const std::size_t count) {
+    auto acc = _mm512_setzero_si512();
+    std::size_t i{};
+    for (; i + 8 <= count; i += 8) {
+        acc = _mm512_add_epi64(
+                acc, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+    }
+    // _mm512_reduce_add_epi64 trips -Wuninitialized in the GCC headers
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    std::size_t ones{};
+    for (const auto lane : lanes) {
+        ones += static_cast<std::size_t>(lane);
+    }
+    return ones + popcount_words(words + i, count - i);
+}
+
+inline const bool Has_Vpopcntdq = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512vpopcntdq") != 0;
+}();
+
+inline std::size_t first_word_sse2(
+        const std::uint64_t *words, const std::size_t count) {
+    std::size_t i{};
+    for (; i + 2 <= count; i += 2) {
+        const auto v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(words + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) !=
+                0xffff) {
+            break;
+        }
+    }
+    return i + first_word_scalar(words + i, count - i);
+}
+
+__attribute__((target("avx2"))) inline std::size_t first_word_avx2(
+        const std::uint64_t *words, const std::size_t count) {
+    std::size_t i{};
+    for (; i + 4 <= count; i += 4) {
+        const auto v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(words + i));
+        if (!_mm256_testz_si256(v, v)) {
+            break;
+        }
+    }
+    return i + first_word_sse2(words + i, count - i);
+}
+
+__attribute__((target("avx512f"))) inline std::size_t first_word_avx512(
+        const std::uint64_t *words, const std::size_t count) {
+    std::size_t i{};
+    for (; i + 8 <= count; i += 8) {
+        const auto v = _mm512_loadu_si512(words + i);
+        if (_mm512_test_epi64_mask(v, v) != 0) {
+            break;
+        }
+    }
+    return i + first_word_avx2(words + i, count - i);
+}
+#endif
+
+// dst[i] = a[i] op b[i] for count words
+template <bit_op Op>
+inline void combine_words(const simd_level level, std::uint64_t *dst,
+        const std::uint64_t *a, const std::uint64_t *b,
+        const std::size_t count) {
+    switch (level) {
+#if defined(__x86_64__)
+        case simd_level::avx512:
+            return combine_avx512<Op>(dst, a, b, count);
+        case simd_level::avx2:
+            return combine_avx2<Op>(dst, a, b, count);
+        case simd_level::sse2:
+            return combine_sse2<Op>(dst, a, b, count);
+#endif
+        default:
+            return combine_scalar<Op>(dst, a, b, count);
+    }
+}
+
+inline std::size_t count_ones_words(const simd_level level,
+        const std::uint64_t *words, const std::size_t count) {
+    switch (level) {
+#if defined(__x86_64__)
+        case simd_level::avx512:
+            if (Has_Vpopcntdq) {
+                return count_ones_avx512(words, count);
+            }
+            return count_ones_avx2(words, count);
+        case simd_level::avx2:
+            return count_ones_avx2(words, count);
+#endif
+        default:
+            return popcount_words(words, count);
+    }
+}
+
+inline std::size_t first_word(const simd_level level,
+        const std::uint64_t *words, const std::size_t count) {
+    switch (level) {
+#if defined(__x86_64__)
+        case simd_level::avx512:
+            return first_word_avx512(words, count);
+        case simd_level::avx2:
+            return first_word_avx2(words, count);
+        case simd_level::sse2:
+            return first_word_sse2(words, count);
+#endif
+        default:
+            return first_word_scalar(words, count);
+    }
+}
+
+template <bit_op Op>
+inline void combine(std::span<std::uint64_t> dst,
+        std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    if (a.size() != b.size() || dst.size() != a.size()) {
+        throw std::length_error("bit arrays of different sizes");
+    }
+    combine_words<Op>(Simd_Level, dst.data(), a.data(), b.data(), dst.size());
+}
+
+inline void bitwise_and(std::span<std::uint64_t> dst,
+        std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    combine<bit_op::and_op>(dst, a, b);
+}
+
+inline void bitwise_or(std::span<std::uint64_t> dst,
+        std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    combine<bit_op::or_op>(dst, a, b);
+}
+
+inline void bitwise_xor(std::span<std::uint64_t> dst,
+        std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    combine<bit_op::xor_op>(dst, a, b);
+}
+
+// dst = a & ~b
+inline void bitwise_andnot(std::span<std::uint64_t> dst,
+        std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    combine<bit_op::andnot_op>(dst, a, b);
+}
+
+inline std::size_t count_ones(std::span<const std::uint64_t> words) {
+    return count_ones_words(Simd_Level, words.data(), words.size());
+}
+
+inline bool any(std::span<const std::uint64_t> words) {
+    return first_word(Simd_Level, words.data(), words.size()) != words.size();
+}
+
+inline bool none(std::span<const std::uint64_t> words) {
+    return !any(words);
+}
+
+// Index of the lowest set bit, words.size() * 64 when there is none
+inline std::size_t find_first(std::span<const std::uint64_t> words) {
+    const auto word = first_word(Simd_Level, words.data(), words.size());
+    if (word == words.size()) {
+        return word * UINT64_BIT_WIDTH;
+    }
+    return word * UINT64_BIT_WIDTH +
+            static_cast<std::size_t>(std::countr_zero(words[word]));
+}
+
+}  // namespace jtl
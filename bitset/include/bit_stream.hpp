@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Bit granular reader and writer over byte buffers
+ *  Neither copies the buffer. Bits go through a 64-bit cache refilled,
+ *  when at least 8 bytes are left, with a single unaligned load. With
+ *  bit_order::msb_first the first bit of the stream is the most
+ *  significant bit of the first byte (network protocols), with
+ *  bit_order::lsb_first it is the least significant one (deflate and
+ *  friends). The checked calls throw std::out_of_range when the buffer
+ *  is too short. The unchecked ones read zeros past the end and drop
+ *  writes past the end, so they never touch memory out of the buffer
+ */
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+enum class bit_order { msb_first, lsb_first };
+
+// Loads 8 bytes as a number whose most significant byte is the first one
+// for msb_first and the last one for lsb_first
+template <bit_order Order>
+constexpr std::uint64_t load_word(const std::byte *ptr) {
+    std::uint64_t word{};
+    if (std::is_constant_evaluated()) {
+        for (std::size_t i = 0; i < sizeof(word); ++i) {
+            const auto byte = std::to_integer<std::uint64_t>(ptr[i]);
+            word |= Order == bit_order::msb_first ? byte << (56 - 8 * i)
+                                                  : byte << (8 * i);
+        }
+        return word;
+    }
+    std::memcpy(&word, ptr, sizeof(word));
+    constexpr auto Native = std::endian::native ==
+            (Order == bit_order::msb_first ? std::endian::big
+                                           : std::endian::little);
+    return Native ? word : __builtin_bswap64(word);
+}
+
+// Width of limb i of an N-bit value, the last one may be partial
+constexpr std::size_t limb_bits(const std::size_t n, const std::size_t i) {
+    return std::min(UINT64_BIT_WIDTH, n - i * UINT64_BIT_WIDTH);
+}
+
+template <bit_order Order = bit_order::msb_first>
+class bit_reader {
+    // Largest read served by a single refill
+    static constexpr std::size_t Max_Fast = 56;
+
+    std::span<const std::byte> buf_;
+    std::size_t pos_{};
+    std::uint64_t cache_{};
+    std::size_t cached_{};
+
+    // Tops the cache up to at least 56 bits unless the buffer runs out
+    constexpr void refill() noexcept {
+        if (pos_ + sizeof(std::uint64_t) <= buf_.size()) {
+            const auto word = load_word<Order>(buf_.data() + pos_);
+            const auto bytes = (63 - cached_) / 8;
+            const auto bits = 8 * bytes;
+            if constexpr (Order == bit_order::msb_first) {
+                cache_ |= (word >> cached_) &
+                        ~low_mask(UINT64_BIT_WIDTH - cached_ - bits);
+            } else {
+                cache_ |= (word & low_mask(bits)) << cached_;
+            }
+            pos_ += bytes;
+            cached_ += bits;
+            return;
+        }
+        for (; cached_ <= Max_Fast && pos_ < buf_.size(); ++pos_) {
+            const auto byte = std::to_integer<std::uint64_t>(buf_[pos_]);
+            if constexpr (Order == bit_order::msb_first) {
+                cache_ |= byte << (Max_Fast - cached_);
+            } else {
+                cache_ |= byte << cached_;
+            }
+            cached_ += 8;
+        }
+    }
+
+    constexpr std::uint64_t peek_fast(const std::size_t count) noexcept {
+        if (cached_ < count) {
+            refill();
+        }
+        if constexpr (Order == bit_order::msb_first) {
+            return count == 0 ? 0 : cache_ >> (UINT64_BIT_WIDTH - count);
+        } else {
+            return cache_ & low_mask(count);
+        }
+    }
+
+    constexpr void consume(std::size_t count) noexcept {
+        count = std::min(count, cached_);
+        if constexpr (Order == bit_order::msb_first) {
+            cache_ = count == UINT64_BIT_WIDTH ? 0 : cache_ << count;
+        } else {
+            cache_ = count == UINT64_BIT_WIDTH ? 0 : cache_ >> count;
+        }
+        cached_ -= count;
+    }
+
+    constexpr void check(const std::size_t count) const {
+        if (count > UINT64_BIT_WIDTH) {
+            throw std::length_error("bit_reader: more than 64 bits");
+        }
+        if (count > remaining()) {
+            throw std::out_of_range("bit_reader: read past the end");
+        }
+    }
+
+ public:
+    constexpr explicit bit_reader(std::span<const std::byte> buf) noexcept
+            : buf_{buf} {}
+
+    // Bits not read yet
+    [[nodiscard]] constexpr std::size_t remaining() const noexcept {
+        return (buf_.size() - pos_) * 8 + cached_;
+    }
+
+    // Bits read so far
+    [[nodiscard]] constexpr std::size_t position() const noexcept {
+        return buf_.size() * 8 - remaining();
+    }
+
+    // Next count <= 64 bits, the first one ends up as the most
+    // significant bit of the result for msb_first and as the least
+    // significant one for lsb_first
+    constexpr std::uint64_t read_unchecked(const std::size_t count) noexcept {
+        if (count > Max_Fast) {
+            // Two refills at most
+            if constexpr (Order == bit_order::msb_first) {
+                const auto high = read_unchecked(count - 32);
+                return (high << 32) | read_unchecked(32);
+            } else {
+                const auto low = read_unchecked(32);
+                return low | (read_unchecked(count - 32) << 32);
+            }
+        }
+        const auto value = peek_fast(count);
+        consume(count);
+        return value;
+    }
+
+    constexpr std::uint64_t read(const std::size_t count) {
+        check(count);
+        return read_unchecked(count);
+    }
+
+    // Next count <= 56 bits, left in the stream
+    constexpr std::uint64_t peek(const std::size_t count) {
+        if (count > Max_Fast) {
+            throw std::length_error("bit_reader: peek of more than 56 bits");
+        }
+        check(count);
+        return peek_fast(count);
+    }
+
+    template <std::size_t N>
+    constexpr std::bitset<N> read() {
+        if (N > remaining()) {
+            throw std::out_of_range("bit_reader: read past the end");
+        }
+        // Limbs are least significant first, msb_first streams start
+        // with the last one
+        words_t<N> words{};
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            const auto limb =
+                    Order == bit_order::msb_first ? words.size() - 1 - i : i;
+            words[limb] = read_unchecked(limb_bits(N, limb));
+        }
+        return from_words<N>(words);
+    }
+
+    constexpr void skip(std::size_t count) {
+        if (count > remaining()) {
+            throw std::out_of_range("bit_reader: skip past the end");
+        }
+        const auto cached = std::min(count, cached_);
+        consume(cached);
+        count -= cached;
+        pos_ += count / 8;
+        read_unchecked(count % 8);
+    }
+
+    // Skips to the next byte boundary
+    constexpr void align() noexcept {
+        consume(cached_ % 8);
+    }
+};
+
+template <bit_order Order = bit_order::msb_first>
+class bit_writer {
+    std::span<std::byte> buf_;
+    std::size_t pos_{};
+    // Bits not yet stored, at most 7 between calls
+    std::uint64_t cache_{};
+    std::size_t pending_{};
+
+    constexpr void drain() noexcept {
+        for (; pending_ >= 8; pending_ -= 8) {
+            if constexpr (Order == bit_order::msb_first) {
+                buf_[pos_++] = static_cast<std::byte>(cache_ >> 56);
+                cache_ <<= 8;
+            } else {
+                buf_[pos_++] = static_cast<std::byte>(cache_);
+                cache_ >>= 8;
+            }
+        }
+    }
+
+    constexpr void put(const std::uint64_t value, const std::size_t count) {
+        if (count == 0) {
+            return;
+        }
+        const auto bits = value & low_mask(count);
+        if constexpr (Order == bit_order::msb_first) {
+            cache_ |= bits << (UINT64_BIT_WIDTH - pending_ - count);
+        } else {
+            cache_ |= bits << pending_;
+        }
+        pending_ += count;
+        drain();
+    }
+
+    constexpr void check(const std::size_t count) const {
+        if (count > UINT64_BIT_WIDTH) {
+            throw std::length_error("bit_writer: more than 64 bits");
+        }
+        if (count > remaining()) {
+            throw std::out_of_range("bit_writer: write past the end");
+        }
+    }
+
+ public:
+    constexpr explicit bit_writer(std::span<std::byte> buf) noexcept
+            : buf_{buf} {}
+
+    bit_writer(const bit_writer &) = delete;
+    bit_writer &operator=(const bit_writer &) = delete;
+
+    // Stores what is left of the last byte
+    constexpr ~bit_writer() {
+        flush();
+    }
+
+    [[nodiscard]] constexpr std::size_t remaining() const noexcept {
+        return (buf_.size() - pos_) * 8 - pending_;
+    }
+
+    [[nodiscard]] constexpr std::size_t position() const noexcept {
+        return pos_ * 8 + pending_;
+    }
+
+    // Appends the count <= 64 low bits of value, mirroring
+    // bit_reader::read_unchecked
+    constexpr void write_unchecked(
+            std::uint64_t value, std::size_t count) noexcept {
+        if (const auto room = remaining(); count > room) {
+            // Only the first bits of the stream fit
+            if constexpr (Order == bit_order::msb_first) {
+                value >>= count - room;
+            }
+            count = room;
+        }
+        if (count > 56) {
+            if constexpr (Order == bit_order::msb_first) {
+                put(value >> 32, count - 32);
+                put(value, 32);
+            } else {
+                put(value, 32);
+                put(value >> 32, count - 32);
+            }
+        } else {
+            put(value, count);
+        }
+    }
+
+    constexpr void write(const std::uint64_t value, const std::size_t count) {
+        check(count);
+        write_unchecked(value, count);
+    }
+
+    template <std::size_t N>
+    constexpr void write(const std::bitset<N> &value) {
+        if (N > remaining()) {
+            throw std::out_of_range("bit_writer: write past the end");
+        }
+        const auto words = to_words(value);
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            const auto limb =
+                    Order == bit_order::msb_first ? words.size() - 1 - i : i;
+            write_unchecked(words[limb], limb_bits(N, limb));
+        }
+    }
+
+    // Pads with zeros up to the next byte boundary
+    constexpr void align() noexcept {
+        if (pending_ % 8 != 0) {
+            put(0, 8 - pending_ % 8);
+        }
+    }
+
+    // Merges the pending bits into the next byte, keeping the bits of
+    // that byte past the write position. Writing can go on afterwards
+    constexpr void flush() noexcept {
+        if (pending_ == 0) {
+            return;
+        }
+        const auto mask = Order == bit_order::msb_first
+                ? ~low_mask(8 - pending_) & 0xff
+                : low_mask(pending_);
+        const auto bits = Order == bit_order::msb_first ? cache_ >> 56
+                                                        : cache_ & 0xff;
+        const auto old = std::to_integer<std::uint64_t>(buf_[pos_]);
+        buf_[pos_] = static_cast<std::byte>((old & ~mask) | (bits & mask));
+    }
+};
+
+}  // namespace jtl
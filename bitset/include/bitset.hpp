@@ -16,11 +16,19 @@
 
 #pragma once
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <bitset>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <cstdint>
+#include <type_traits>
 
 #include "common.hpp"
 
@@ -39,8 +47,13 @@ template <std::size_t N>
 [[maybe_unused]] static constexpr bool is_trivially_constructible_v = (N <=
         UINT64_BIT_WIDTH);
 
+// Only the bit accessor is constexpr in C++20, the bit loop is left to
+// constant evaluation
 constexpr auto to_uint64(const auto &bs) requires(
         Is_Trivially_Constructible<decltype(bs)>) {
+    if (!std::is_constant_evaluated()) {
+        return static_cast<std::uint64_t>(bs.to_ullong());
+    }
     auto Size = rm_cvref_t<decltype(bs)>().size();
     std::uint64_t result{};
     for (std::uint64_t i = 0; i < Size; ++i) {
@@ -49,6 +62,136 @@ constexpr auto to_uint64(const auto &bs) requires(
     return result;
 }
 
+// Wide bitsets are handled as arrays of 64-bit limbs, least significant
+// limb first, so no operation has to go through strings
+template <std::size_t N>
+static constexpr auto Words_Count =
+        (N + UINT64_BIT_WIDTH - 1) / UINT64_BIT_WIDTH;
+
+template <std::size_t N>
+using words_t = std::array<std::uint64_t, Words_Count<N>>;
+
+constexpr std::uint64_t low_mask(const std::uint64_t count) {
+    return count >= UINT64_BIT_WIDTH
+            ? ~std::uint64_t{}
+            : (std::uint64_t{1} << count) - 1;
+}
+
+// Reads count <= 64 bits starting at bit offset
+constexpr std::uint64_t extract(const std::uint64_t *words,
+        const std::uint64_t offset, const std::uint64_t count) {
+    const auto word = offset / UINT64_BIT_WIDTH;
+    const auto bit = offset % UINT64_BIT_WIDTH;
+    auto value = words[word] >> bit;
+    if (bit != 0 && bit + count > UINT64_BIT_WIDTH) {
+        value |= words[word + 1] << (UINT64_BIT_WIDTH - bit);
+    }
+    return value & low_mask(count);
+}
+
+template <std::size_t W>
+constexpr std::uint64_t extract(const std::array<std::uint64_t, W> &words,
+        const std::uint64_t offset, const std::uint64_t count) {
+    return extract(words.data(), offset, count);
+}
+
+// Ors the count <= 64 low bits of value in starting at bit offset
+constexpr void deposit(std::uint64_t *words, const std::uint64_t offset,
+        const std::uint64_t value, const std::uint64_t count) {
+    const auto word = offset / UINT64_BIT_WIDTH;
+    const auto bit = offset % UINT64_BIT_WIDTH;
+    const auto masked = value & low_mask(count);
+    words[word] |= masked << bit;
+    if (bit != 0 && bit + count > UINT64_BIT_WIDTH) {
+        words[word + 1] |= masked >> (UINT64_BIT_WIDTH - bit);
+    }
+}
+
+template <std::size_t W>
+constexpr void deposit(std::array<std::uint64_t, W> &words,
+        const std::uint64_t offset, const std::uint64_t value,
+        const std::uint64_t count) {
+    deposit(words.data(), offset, value, count);
+}
+
+// Overwrites count <= 64 bits starting at bit offset with value
+constexpr void store(std::uint64_t *words, const std::uint64_t offset,
+        const std::uint64_t value, const std::uint64_t count) {
+    const auto word = offset / UINT64_BIT_WIDTH;
+    const auto bit = offset % UINT64_BIT_WIDTH;
+    words[word] &= ~(low_mask(count) << bit);
+    if (bit != 0 && bit + count > UINT64_BIT_WIDTH) {
+        words[word + 1] &= ~(low_mask(count) >> (UINT64_BIT_WIDTH - bit));
+    }
+    deposit(words, offset, value, count);
+}
+
+template <std::size_t W>
+constexpr void store(std::array<std::uint64_t, W> &words,
+        const std::uint64_t offset, const std::uint64_t value,
+        const std::uint64_t count) {
+    store(words.data(), offset, value, count);
+}
+
+template <std::size_t N>
+constexpr auto to_words(const std::bitset<N> &bs) {
+    words_t<N> words{};
+    if constexpr (N <= UINT64_BIT_WIDTH) {
+        words[0] = to_uint64(bs);
+    } else if (std::is_constant_evaluated()) {
+        for (std::size_t i = 0; i < N; ++i) {
+            words[i / UINT64_BIT_WIDTH] |= static_cast<std::uint64_t>(bs[i])
+                    << (i % UINT64_BIT_WIDTH);
+        }
+    } else {
+        const std::bitset<N> mask{~std::uint64_t{}};
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            words[i] = ((bs >> (i * UINT64_BIT_WIDTH)) & mask).to_ullong();
+        }
+    }
+    return words;
+}
+
+// Constant evaluation of wide bitsets needs the C++23 constexpr bitset
+template <std::size_t N>
+constexpr auto from_words(const words_t<N> &words) {
+    if constexpr (N <= UINT64_BIT_WIDTH) {
+        return std::bitset<N>{words[0]};
+    } else {
+        std::bitset<N> bs{};
+        for (auto i = words.size(); i-- > 0;) {
+            bs <<= UINT64_BIT_WIDTH;
+            bs |= std::bitset<N>{words[i]};
+        }
+        return bs;
+    }
+}
+
+// Ors the first count bits of src in starting at bit offset
+template <std::size_t W, std::size_t Src_W>
+constexpr void deposit_words(std::array<std::uint64_t, W> &words,
+        const std::uint64_t offset,
+        const std::array<std::uint64_t, Src_W> &src,
+        const std::uint64_t count) {
+    for (std::size_t i = 0; i < Src_W; ++i) {
+        const auto done = i * UINT64_BIT_WIDTH;
+        deposit(words, offset + done, src[i],
+                std::min<std::uint64_t>(UINT64_BIT_WIDTH, count - done));
+    }
+}
+
+// Limbs of the concatenation, the first bitset ends up in the most
+// significant bits
+constexpr auto concat_words(const auto &...bitsets) {
+    constexpr auto Size = jtl::sum(rm_cvref_t<decltype(bitsets)>().size()...);
+    words_t<Size> words{};
+    std::uint64_t offset{Size};
+    ((offset -= bitsets.size(),
+             deposit_words(words, offset, to_words(bitsets), bitsets.size())),
+            ...);
+    return words;
+}
+
 constexpr auto concat(const auto &...bitsets) requires(
         Is_Trivially_Constructible<decltype(bitsets)...>) {
     constexpr auto Size = jtl::sum(rm_cvref_t<decltype(bitsets)>().size()...);
@@ -64,78 +207,232 @@ constexpr auto concat(const auto &...bitsets) requires(
     return std::bitset<Size>{bs_uint};
 }
 
-auto concat(const auto &...bitsets) requires(
+constexpr auto concat(const auto &...bitsets) requires(
         !Is_Trivially_Constructible<decltype(bitsets)...>) {
     constexpr auto Size = jtl::sum(rm_cvref_t<decltype(bitsets)>().size()...);
-    const auto list_string = std::array{bitsets.to_string()...};
-    std::string bs_str;
-    for (const auto &bs : list_string) {
-        bs_str += bs;
-    }
-    return std::bitset<Size>{bs_str};
+    return from_words<Size>(concat_words(bitsets...));
 }
 
-constexpr auto get_split_shift(const auto a, const auto b) {
-    return (a - b) < UINT64_BIT_WIDTH ? (a - b) : 0;
+// Limbs of the count bits starting at bit offset
+template <std::size_t Count, std::size_t W>
+constexpr auto extract_words(const std::array<std::uint64_t, W> &words,
+        const std::uint64_t offset) {
+    words_t<Count> field{};
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        const auto done = i * UINT64_BIT_WIDTH;
+        field[i] = extract(words, offset + done,
+                std::min<std::uint64_t>(UINT64_BIT_WIDTH, Count - done));
+    }
+    return field;
 }
 
-auto split(const auto &bs, auto &bs1) {
-    static_assert(rm_cvref_t<decltype(bs)>().size() ==
-            rm_cvref_t<decltype(bs1)>().size());
-    bs1 = rm_cvref_t<decltype(bs1)>{bs};
+// Fields as wide as the destinations, the first one takes the most
+// significant bits. The source is read once, no intermediate bitset is
+// built on the way
+constexpr void split(const auto &bs, auto &...bitsets) requires(
+        sizeof...(bitsets) > 0) {
+    constexpr std::uint64_t Bs_Size = rm_cvref_t<decltype(bs)>().size();
+    static_assert(Bs_Size ==
+            jtl::sum(rm_cvref_t<decltype(bitsets)>().size()...));
+    const auto words = to_words(bs);
+    std::uint64_t offset{Bs_Size};
+    ((offset -= bitsets.size(),
+             bitsets = from_words<rm_cvref_t<decltype(bitsets)>().size()>(
+                     extract_words<rm_cvref_t<decltype(bitsets)>().size()>(
+                             words, offset))),
+            ...);
 }
 
-auto split(const auto &bs, auto &bs1, auto &...bitsets) {
-    constexpr std::uint64_t Bs_Size = rm_cvref_t<decltype(bs)>().size();
-    constexpr std::uint64_t Bs1_Size = rm_cvref_t<decltype(bs1)>().size();
-    constexpr std::uint64_t Bsrest_Size =
-            jtl::sum(rm_cvref_t<decltype(bitsets)>().size()...);
-    static_assert(Bs_Size == Bs1_Size + Bsrest_Size);
-    constexpr auto Use_Str =
-            !is_trivially_constructible_v<rm_cvref_t<decltype(bs)>().size()>;
-    constexpr auto Shift = Bs_Size - Bs1_Size;
-    if constexpr (Use_Str) {
-        bs1 = rm_cvref_t<decltype(bs1)>{bs.to_string().substr(0, Bs1_Size)};
-        const auto &bs2 =
-                std::bitset<Shift>{bs.to_string().substr(Bs1_Size, Shift)};
-        split(bs2, bitsets...);
-    } else {
-        constexpr auto Shift_Uint = get_split_shift(Bs_Size, Bs1_Size);
-        constexpr auto Mask = (static_cast<std::uint64_t>(1) << Shift_Uint) - 1;
-        bs1 = rm_cvref_t<decltype(bs1)>{(bs >> Shift).to_ulong()};
-        const auto &bs2 = std::bitset<Shift>{
-                (bs & rm_cvref_t<decltype(bs)>{Mask}).to_ulong()};
-        split(bs2, bitsets...);
-    }
+constexpr std::uint64_t shift_mask(const std::uint64_t value,
+        const std::uint64_t offset, const std::uint64_t count) {
+    return offset >= UINT64_BIT_WIDTH ? 0 : (value >> offset) & low_mask(count);
 }
 
 template <std::size_t Offset, std::size_t Count>
 constexpr auto range(const auto &bs) requires(
         Is_Trivially_Constructible<decltype(bs)> &&
         (Offset + Count) <= rm_cvref_t<decltype(bs)>().size()) {
-    std::uint64_t bs_uint{};
-    for (auto idx = Offset; idx < Offset + Count; ++idx) {
-        bs_uint |= bs[idx] << (idx - Offset);
-    }
-    return std::bitset<Count>{bs_uint};
+    return std::bitset<Count>{shift_mask(to_uint64(bs), Offset, Count)};
 }
 
 constexpr auto range(const auto &bs, const std::uint64_t offset,
         const std::uint64_t
                 count) requires(Is_Trivially_Constructible<decltype(bs)>) {
-    std::uint64_t bs_uint{};
-    for (auto idx = offset; idx < offset + count; ++idx) {
-        bs_uint |= bs[idx] << (idx - offset);
-    }
-    return rm_cvref_t<decltype(bs)>{bs_uint};
+    return rm_cvref_t<decltype(bs)>{shift_mask(to_uint64(bs), offset, count)};
 }
 
-auto range(const auto &bs, const std::uint64_t offset,
+constexpr auto range(const auto &bs, const std::uint64_t offset,
         const std::uint64_t
                 count) requires(!Is_Trivially_Constructible<decltype(bs)>) {
     constexpr auto Bs_Size = rm_cvref_t<decltype(bs)>().size();
-    return rm_cvref_t<decltype(bs)>{
-            bs.to_string().substr(Bs_Size - offset - count, count)};
+    if (offset > Bs_Size || count > Bs_Size - offset) {
+        throw std::out_of_range("jtl::range: field past the end of the bitset");
+    }
+    const auto words = to_words(bs);
+    words_t<Bs_Size> result{};
+    for (std::uint64_t done = 0; done < count; done += UINT64_BIT_WIDTH) {
+        result[done / UINT64_BIT_WIDTH] = extract(words, offset + done,
+                std::min<std::uint64_t>(UINT64_BIT_WIDTH, count - done));
+    }
+    return from_words<Bs_Size>(result);
+}
+
+// Copy of bs whose bits [offset, offset + value.size()) are replaced by
+// value, the counterpart of range. Bits of value landing past the end of
+// bs are dropped
+constexpr auto insert_range(const auto &bs, const std::uint64_t offset,
+        const auto &value) requires(Is_Trivially_Constructible<decltype(bs)>) {
+    if (offset >= bs.size()) {
+        return rm_cvref_t<decltype(bs)>{bs};
+    }
+    const auto mask = low_mask(value.size()) << offset;
+    return rm_cvref_t<decltype(bs)>{(to_uint64(bs) & ~mask) |
+            ((to_uint64(value) << offset) & mask)};
+}
+
+constexpr auto insert_range(const auto &bs, const std::uint64_t offset,
+        const auto &value) requires(!Is_Trivially_Constructible<decltype(bs)>) {
+    constexpr auto Bs_Size = rm_cvref_t<decltype(bs)>().size();
+    constexpr std::uint64_t Count = rm_cvref_t<decltype(value)>().size();
+    if (offset >= Bs_Size) {
+        return rm_cvref_t<decltype(bs)>{bs};
+    }
+    const auto fits = std::min<std::uint64_t>(Count, Bs_Size - offset);
+    auto words = to_words(bs);
+    const auto value_words = to_words(value);
+    for (std::uint64_t done = 0; done < fits; done += UINT64_BIT_WIDTH) {
+        store(words, offset + done, value_words[done / UINT64_BIT_WIDTH],
+                std::min<std::uint64_t>(UINT64_BIT_WIDTH, fits - done));
+    }
+    return from_words<Bs_Size>(words);
+}
+
+// Non-contiguous fields. extract_bits packs the bits of value selected by
+// mask into the low bits of the result, deposit_bits spreads the low bits
+// of value over the bits set in mask. The portable loops cost one
+// iteration per mask bit, BMI2 does either in a single instruction
+constexpr std::uint64_t pext_portable(
+        const std::uint64_t value, std::uint64_t mask) {
+    std::uint64_t result{};
+    for (std::uint64_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1) {
+        if ((value & mask & -mask) != 0) {
+            result |= bit;
+        }
+    }
+    return result;
+}
+
+constexpr std::uint64_t pdep_portable(
+        const std::uint64_t value, std::uint64_t mask) {
+    std::uint64_t result{};
+    for (std::uint64_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1) {
+        if ((value & bit) != 0) {
+            result |= mask & -mask;
+        }
+    }
+    return result;
+}
+
+#if defined(__x86_64__) && !defined(__BMI2__)
+__attribute__((target("bmi2"))) inline std::uint64_t pext_bmi2(
+        const std::uint64_t value, const std::uint64_t mask) {
+    return _pext_u64(value, mask);
+}
+
+__attribute__((target("bmi2"))) inline std::uint64_t pdep_bmi2(
+        const std::uint64_t value, const std::uint64_t mask) {
+    return _pdep_u64(value, mask);
+}
+
+// Checked once, builds targeting BMI2 skip the check altogether
+inline const bool Has_Bmi2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2") != 0;
+}();
+#endif
+
+constexpr std::uint64_t extract_bits(
+        const std::uint64_t value, const std::uint64_t mask) {
+    if (std::is_constant_evaluated()) {
+        return pext_portable(value, mask);
+    }
+#if defined(__x86_64__) && defined(__BMI2__)
+    return _pext_u64(value, mask);
+#elif defined(__x86_64__)
+    return Has_Bmi2 ? pext_bmi2(value, mask) : pext_portable(value, mask);
+#else
+    return pext_portable(value, mask);
+#endif
+}
+
+constexpr std::uint64_t deposit_bits(
+        const std::uint64_t value, const std::uint64_t mask) {
+    if (std::is_constant_evaluated()) {
+        return pdep_portable(value, mask);
+    }
+#if defined(__x86_64__) && defined(__BMI2__)
+    return _pdep_u64(value, mask);
+#elif defined(__x86_64__)
+    return Has_Bmi2 ? pdep_bmi2(value, mask) : pdep_portable(value, mask);
+#else
+    return pdep_portable(value, mask);
+#endif
+}
+
+// Field made of the bits of bs selected by Mask, the lowest selected bit
+// becomes bit 0
+template <std::uint64_t Mask>
+constexpr auto gather(const auto &bs) requires(
+        Is_Trivially_Constructible<decltype(bs)>) {
+    return std::bitset<std::popcount(Mask)>{
+            extract_bits(to_uint64(bs), Mask)};
+}
+
+// Copy of bs whose bits selected by Mask are replaced by value, the
+// counterpart of gather
+template <std::uint64_t Mask>
+constexpr auto scatter(const auto &bs, const auto &value) requires(
+        Is_Trivially_Constructible<decltype(bs)> &&
+        rm_cvref_t<decltype(value)>().size() == std::popcount(Mask)) {
+    return rm_cvref_t<decltype(bs)>{(to_uint64(bs) & ~Mask) |
+            deposit_bits(to_uint64(value), Mask)};
+}
+
+// Number of ones in count words. Without a POPCNT target the compiler
+// falls back to a bit-twiddling routine, so the loop is dispatched as a
+// whole on CPUID
+#if defined(__x86_64__) && !defined(__POPCNT__)
+__attribute__((target("popcnt"))) inline std::size_t popcount_popcnt(
+        const std::uint64_t *words, const std::size_t count) {
+    std::size_t ones{};
+    for (std::size_t i = 0; i < count; ++i) {
+        ones += static_cast<std::size_t>(__builtin_popcountll(words[i]));
+    }
+    return ones;
+}
+
+inline const bool Has_Popcnt = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("popcnt") != 0;
+}();
+#endif
+
+inline std::size_t popcount_words(
+        const std::uint64_t *words, const std::size_t count) {
+#if defined(__x86_64__) && !defined(__POPCNT__)
+    if (Has_Popcnt) {
+        return popcount_popcnt(words, count);
+    }
+#endif
+    std::size_t ones{};
+    for (std::size_t i = 0; i < count; ++i) {
+        ones += static_cast<std::size_t>(std::popcount(words[i]));
+    }
+    return ones;
+}
+
+inline std::size_t popcount_word(const std::uint64_t word) {
+    return popcount_words(&word, 1);
 }
 
 }  // namespace jtl
@@ -0,0 +1,812 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Set of 32-bit integers stored the roaring way
+ *  Values are grouped by their 16 high bits into chunks of 64K. A chunk
+ *  is kept as a sorted array of its low halves while it holds up to 4096
+ *  of them, as an 8 KiB bitmap beyond that, or as a list of runs after
+ *  run_optimize finds runs smaller than both. Set operations go chunk by
+ *  chunk: array against array merges, run list against run list walks
+ *  both interval lists, everything else goes through the bit_kernels.hpp
+ *  word kernels. A chunk combined with a run list comes out in whichever
+ *  form is smallest, so clustered sets stay small without run_optimize
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "bit_kernels.hpp"
+#include "bitset.hpp"
+
+namespace jtl {
+
+class compressed_bitmap {
+ public:
+    using value_type = std::uint32_t;
+    using size_type = std::size_t;
+
+ private:
+    static constexpr std::size_t Chunk_Words = (std::size_t{1} << 16) / 64;
+    static constexpr std::size_t Array_Max = 4096;
+
+    struct array_container {
+        std::vector<std::uint16_t> values;
+    };
+
+    struct bitmap_container {
+        std::vector<std::uint64_t> words =
+                std::vector<std::uint64_t>(Chunk_Words);
+        std::size_t cardinality{};
+    };
+
+    // Inclusive bounds
+    struct run {
+        std::uint16_t start;
+        std::uint16_t last;
+    };
+
+    struct run_container {
+        std::vector<run> runs;
+    };
+
+    using container =
+            std::variant<array_container, bitmap_container, run_container>;
+
+    std::vector<std::uint16_t> keys_;
+    std::vector<container> containers_;
+
+    static constexpr std::uint16_t high(const value_type value) {
+        return static_cast<std::uint16_t>(value >> 16);
+    }
+
+    static constexpr std::uint16_t low(const value_type value) {
+        return static_cast<std::uint16_t>(value);
+    }
+
+    static bool test_bit(const std::vector<std::uint64_t> &words,
+            const std::uint16_t bit) noexcept {
+        return ((words[bit / 64] >> (bit % 64)) & 1) != 0;
+    }
+
+    // Sets the bits of [first, last]
+    static void set_range(std::vector<std::uint64_t> &words,
+            const std::size_t first, const std::size_t last) noexcept {
+        const auto first_word = first / 64;
+        const auto last_word = last / 64;
+        const auto head = ~std::uint64_t{} << (first % 64);
+        const auto tail = low_mask(last % 64 + 1);
+        if (first_word == last_word) {
+            words[first_word] |= head & tail;
+            return;
+        }
+        words[first_word] |= head;
+        std::fill(words.begin() + static_cast<std::ptrdiff_t>(first_word) + 1,
+                words.begin() + static_cast<std::ptrdiff_t>(last_word),
+                ~std::uint64_t{});
+        words[last_word] |= tail;
+    }
+
+    static std::size_t cardinality(const container &c) noexcept {
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            return array->values.size();
+        }
+        if (const auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            return bitmap->cardinality;
+        }
+        std::size_t count{};
+        for (const auto &r : std::get<run_container>(c).runs) {
+            count += static_cast<std::size_t>(r.last - r.start) + 1;
+        }
+        return count;
+    }
+
+    static bool contains(const container &c, const std::uint16_t value) {
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            return std::binary_search(
+                    array->values.begin(), array->values.end(), value);
+        }
+        if (const auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            return test_bit(bitmap->words, value);
+        }
+        const auto &runs = std::get<run_container>(c).runs;
+        auto it = std::upper_bound(runs.begin(), runs.end(), value,
+                [](std::uint16_t v, const run &r) { return v < r.start; });
+        return it != runs.begin() && std::prev(it)->last >= value;
+    }
+
+    static bitmap_container to_bitmap(const container &c) {
+        if (const auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            return *bitmap;
+        }
+        bitmap_container bitmap;
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            for (const auto value : array->values) {
+                bitmap.words[value / 64] |= std::uint64_t{1} << (value % 64);
+            }
+        } else {
+            for (const auto &r : std::get<run_container>(c).runs) {
+                set_range(bitmap.words, r.start, r.last);
+            }
+        }
+        bitmap.cardinality = cardinality(c);
+        return bitmap;
+    }
+
+    static array_container to_array(const bitmap_container &bitmap) {
+        array_container array;
+        array.values.reserve(bitmap.cardinality);
+        for (std::size_t i = 0; i < Chunk_Words; ++i) {
+            for (auto word = bitmap.words[i]; word != 0; word &= word - 1) {
+                array.values.push_back(static_cast<std::uint16_t>(
+                        i * 64 + static_cast<std::size_t>(
+                                         std::countr_zero(word))));
+            }
+        }
+        return array;
+    }
+
+    // Array or bitmap, whichever the cardinality calls for
+    static container shrink(bitmap_container &&bitmap) {
+        if (bitmap.cardinality <= Array_Max) {
+            return to_array(bitmap);
+        }
+        return std::move(bitmap);
+    }
+
+    static container shrink(array_container &&array) {
+        if (array.values.size() <= Array_Max) {
+            return std::move(array);
+        }
+        return to_bitmap(array);
+    }
+
+    // Inserts r, merging the runs it overlaps or touches
+    static void add_run(run_container &c, const run r) {
+        auto &runs = c.runs;
+        const auto first = std::lower_bound(runs.begin(), runs.end(), r.start,
+                [](const run &a, std::uint16_t v) { return a.last + 1 < v; });
+        const auto last = std::upper_bound(first, runs.end(), r.last,
+                [](std::uint16_t v, const run &a) { return v + 1 < a.start; });
+        if (first == last) {
+            runs.insert(first, r);
+            return;
+        }
+        *first = run{std::min(first->start, r.start),
+                std::max(std::prev(last)->last, r.last)};
+        runs.erase(std::next(first), last);
+    }
+
+    static void add(container &c, const std::uint16_t value) {
+        if (auto *array = std::get_if<array_container>(&c)) {
+            auto &values = array->values;
+            const auto it =
+                    std::lower_bound(values.begin(), values.end(), value);
+            if (it == values.end() || *it != value) {
+                values.insert(it, value);
+                if (values.size() > Array_Max) {
+                    c = to_bitmap(c);
+                }
+            }
+        } else if (auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            auto &word = bitmap->words[value / 64];
+            const auto bit = std::uint64_t{1} << (value % 64);
+            bitmap->cardinality += (word & bit) == 0;
+            word |= bit;
+        } else {
+            add_run(std::get<run_container>(c), run{value, value});
+        }
+    }
+
+    static void remove(container &c, const std::uint16_t value) {
+        if (auto *array = std::get_if<array_container>(&c)) {
+            auto &values = array->values;
+            const auto it =
+                    std::lower_bound(values.begin(), values.end(), value);
+            if (it != values.end() && *it == value) {
+                values.erase(it);
+            }
+        } else if (auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            auto &word = bitmap->words[value / 64];
+            const auto bit = std::uint64_t{1} << (value % 64);
+            bitmap->cardinality -= (word & bit) != 0;
+            word &= ~bit;
+            if (bitmap->cardinality <= Array_Max) {
+                c = to_array(*bitmap);
+            }
+        } else {
+            auto &runs = std::get<run_container>(c).runs;
+            auto it = std::upper_bound(runs.begin(), runs.end(), value,
+                    [](std::uint16_t v, const run &r) { return v < r.start; });
+            if (it == runs.begin() || std::prev(it)->last < value) {
+                return;
+            }
+            auto &r = *std::prev(it);
+            if (r.start == r.last) {
+                runs.erase(std::prev(it));
+            } else if (r.start == value) {
+                ++r.start;
+            } else if (r.last == value) {
+                --r.last;
+            } else {
+                const run tail{static_cast<std::uint16_t>(value + 1), r.last};
+                r.last = static_cast<std::uint16_t>(value - 1);
+                runs.insert(it, tail);
+            }
+        }
+    }
+
+    static std::size_t count_runs(const container &c) {
+        if (const auto *runs = std::get_if<run_container>(&c)) {
+            return runs->runs.size();
+        }
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            const auto &values = array->values;
+            std::size_t count = values.empty() ? 0 : 1;
+            for (std::size_t i = 1; i < values.size(); ++i) {
+                count += values[i] != values[i - 1] + 1;
+            }
+            return count;
+        }
+        // A run starts at every one whose lower neighbour is a zero
+        const auto &words = std::get<bitmap_container>(c).words;
+        std::size_t count{};
+        std::uint64_t carry{};
+        for (const auto word : words) {
+            count += static_cast<std::size_t>(
+                    std::popcount(word & ~((word << 1) | carry)));
+            carry = word >> 63;
+        }
+        return count;
+    }
+
+    static run_container to_runs(const container &c) {
+        run_container runs;
+        for_each(c, [&](std::uint16_t value) {
+            if (!runs.runs.empty() && runs.runs.back().last + 1 == value) {
+                runs.runs.back().last = value;
+            } else {
+                runs.runs.push_back(run{value, value});
+            }
+        });
+        return runs;
+    }
+
+    static std::size_t size_in_bytes(const container &c) noexcept {
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            return array->values.size() * sizeof(std::uint16_t);
+        }
+        if (std::holds_alternative<bitmap_container>(c)) {
+            return Chunk_Words * sizeof(std::uint64_t);
+        }
+        return std::get<run_container>(c).runs.size() * sizeof(run);
+    }
+
+    template <typename Func>
+    static void for_each(const container &c, Func &&func) {
+        if (const auto *array = std::get_if<array_container>(&c)) {
+            for (const auto value : array->values) {
+                func(value);
+            }
+        } else if (const auto *bitmap = std::get_if<bitmap_container>(&c)) {
+            for (std::size_t i = 0; i < Chunk_Words; ++i) {
+                for (auto word = bitmap->words[i]; word != 0;
+                        word &= word - 1) {
+                    func(static_cast<std::uint16_t>(
+                            i * 64 + static_cast<std::size_t>(
+                                             std::countr_zero(word))));
+                }
+            }
+        } else {
+            for (const auto &r : std::get<run_container>(c).runs) {
+                for (std::size_t value = r.start; value <= r.last; ++value) {
+                    func(static_cast<std::uint16_t>(value));
+                }
+            }
+        }
+    }
+
+    // Containers of the same chunk combined word by word
+    template <bit_op Op>
+    static container combine_bitmaps(const container &a, const container &b) {
+        auto result = to_bitmap(a);
+        const auto other = to_bitmap(b);
+        combine_words<Op>(Simd_Level, result.words.data(), result.words.data(),
+                other.words.data(), Chunk_Words);
+        result.cardinality = count_ones_words(
+                Simd_Level, result.words.data(), Chunk_Words);
+        return shrink(std::move(result));
+    }
+
+    template <bit_op Op>
+    static constexpr bool keeps(const bool in_a, const bool in_b) noexcept {
+        if constexpr (Op == bit_op::and_op) {
+            return in_a && in_b;
+        } else if constexpr (Op == bit_op::or_op) {
+            return in_a || in_b;
+        } else if constexpr (Op == bit_op::xor_op) {
+            return in_a != in_b;
+        } else {
+            return in_a && !in_b;
+        }
+    }
+
+    // Run lists combined stretch by stretch. Each side goes in or out of
+    // a run at its edges, Op tells which stretches end up in the result
+    template <bit_op Op>
+    static run_container combine_runs(
+            const run_container &a, const run_container &b) {
+        constexpr std::uint32_t End = std::uint32_t{1} << 16;
+        const auto edge = [](const std::vector<run> &runs, std::size_t k,
+                                  bool inside) -> std::uint32_t {
+            if (k == runs.size()) {
+                return End;
+            }
+            return inside ? std::uint32_t{runs[k].last} + 1
+                          : std::uint32_t{runs[k].start};
+        };
+        const auto cross = [&](const std::vector<run> &runs, std::size_t &k,
+                                   bool &inside, std::uint32_t at) {
+            // Runs that touch are crossed in one go
+            while (edge(runs, k, inside) == at) {
+                if (inside) {
+                    ++k;
+                }
+                inside = !inside;
+            }
+        };
+        run_container result;
+        std::size_t i{};
+        std::size_t j{};
+        bool in_a{};
+        bool in_b{};
+        bool kept{};
+        std::uint32_t open{};
+        for (;;) {
+            const auto at =
+                    std::min(edge(a.runs, i, in_a), edge(b.runs, j, in_b));
+            if (at == End) {
+                break;
+            }
+            cross(a.runs, i, in_a, at);
+            cross(b.runs, j, in_b, at);
+            const auto keep = keeps<Op>(in_a, in_b);
+            if (keep && !kept) {
+                open = at;
+            } else if (!keep && kept) {
+                result.runs.push_back(run{static_cast<std::uint16_t>(open),
+                        static_cast<std::uint16_t>(at - 1)});
+            }
+            kept = keep;
+        }
+        if (kept) {
+            result.runs.push_back(
+                    run{static_cast<std::uint16_t>(open), 0xffff});
+        }
+        return result;
+    }
+
+    // Whichever of runs, array or bitmap takes the least room
+    static container fit(container &&c) {
+        const auto runs_bytes = count_runs(c) * sizeof(run);
+        const auto card = cardinality(c);
+        const auto plain_bytes = card <= Array_Max
+                ? card * sizeof(std::uint16_t)
+                : Chunk_Words * sizeof(std::uint64_t);
+        const auto is_runs = std::holds_alternative<run_container>(c);
+        if (runs_bytes < plain_bytes) {
+            return is_runs ? std::move(c) : container{to_runs(c)};
+        }
+        return is_runs ? shrink(to_bitmap(c)) : std::move(c);
+    }
+
+    // Run lists against each other stay run lists, the rest goes through
+    // the word kernels. Results with a run list in them are refitted
+    template <bit_op Op>
+    static container combine(const container &a, const container &b) {
+        const auto *lhs = std::get_if<run_container>(&a);
+        const auto *rhs = std::get_if<run_container>(&b);
+        if (lhs != nullptr && rhs != nullptr) {
+            return fit(combine_runs<Op>(*lhs, *rhs));
+        }
+        auto result = combine_bitmaps<Op>(a, b);
+        if (lhs != nullptr || rhs != nullptr) {
+            return fit(std::move(result));
+        }
+        return result;
+    }
+
+    // Values of an array kept or dropped depending on the other container
+    static container filter(
+            const array_container &array, const container &other, bool keep) {
+        array_container result;
+        std::copy_if(array.values.begin(), array.values.end(),
+                std::back_inserter(result.values),
+                [&](std::uint16_t v) { return contains(other, v) == keep; });
+        return result;
+    }
+
+    template <typename Set_Op>
+    static container merge_arrays(
+            const container &a, const container &b, Set_Op op) {
+        const auto &lhs = std::get<array_container>(a).values;
+        const auto &rhs = std::get<array_container>(b).values;
+        array_container result;
+        result.values.reserve(lhs.size() + rhs.size());
+        op(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                std::back_inserter(result.values));
+        return shrink(std::move(result));
+    }
+
+    static bool is_array(const container &c) noexcept {
+        return std::holds_alternative<array_container>(c);
+    }
+
+    static container and_containers(const container &a, const container &b) {
+        if (is_array(a)) {
+            return filter(std::get<array_container>(a), b, true);
+        }
+        if (is_array(b)) {
+            return filter(std::get<array_container>(b), a, true);
+        }
+        return combine<bit_op::and_op>(a, b);
+    }
+
+    static container or_containers(const container &a, const container &b) {
+        if (is_array(a) && is_array(b)) {
+            return merge_arrays(a, b, [](auto... args) {
+                return std::set_union(args...);
+            });
+        }
+        return combine<bit_op::or_op>(a, b);
+    }
+
+    static container andnot_containers(
+            const container &a, const container &b) {
+        if (is_array(a)) {
+            return filter(std::get<array_container>(a), b, false);
+        }
+        return combine<bit_op::andnot_op>(a, b);
+    }
+
+    static container xor_containers(const container &a, const container &b) {
+        if (is_array(a) && is_array(b)) {
+            return merge_arrays(a, b, [](auto... args) {
+                return std::set_symmetric_difference(args...);
+            });
+        }
+        return combine<bit_op::xor_op>(a, b);
+    }
+
+    // Walks both chunk lists in key order. Keep_Left/Keep_Right copy the
+    // chunks found on one side only, op combines the ones on both
+    template <bool Keep_Left, bool Keep_Right, typename Op>
+    static compressed_bitmap merge(const compressed_bitmap &a,
+            const compressed_bitmap &b, Op op) {
+        compressed_bitmap result;
+        std::size_t i{};
+        std::size_t j{};
+        const auto push = [&](std::uint16_t key, container &&c) {
+            if (cardinality(c) != 0) {
+                result.keys_.push_back(key);
+                result.containers_.push_back(std::move(c));
+            }
+        };
+        while (i < a.keys_.size() || j < b.keys_.size()) {
+            if (j == b.keys_.size() ||
+                    (i < a.keys_.size() && a.keys_[i] < b.keys_[j])) {
+                if constexpr (Keep_Left) {
+                    push(a.keys_[i], container{a.containers_[i]});
+                }
+                ++i;
+            } else if (i == a.keys_.size() || b.keys_[j] < a.keys_[i]) {
+                if constexpr (Keep_Right) {
+                    push(b.keys_[j], container{b.containers_[j]});
+                }
+                ++j;
+            } else {
+                push(a.keys_[i], op(a.containers_[i], b.containers_[j]));
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    std::size_t find(const std::uint16_t key) const noexcept {
+        return static_cast<std::size_t>(
+                std::lower_bound(keys_.begin(), keys_.end(), key) -
+                keys_.begin());
+    }
+
+ public:
+    // Forward iterator over the values in increasing order
+    class const_iterator {
+        friend class compressed_bitmap;
+
+        const compressed_bitmap *bitmap_{};
+        std::size_t chunk_{};
+        // Element, run or bit index depending on the container
+        std::size_t index_{};
+        std::size_t offset_{};
+
+        const container &current() const {
+            return bitmap_->containers_[chunk_];
+        }
+
+        // Moves to the first value at or after the current state, going
+        // to the next chunks when this one is exhausted
+        void settle() {
+            for (; chunk_ < bitmap_->containers_.size();
+                    ++chunk_, index_ = 0, offset_ = 0) {
+                const auto &c = current();
+                if (const auto *array = std::get_if<array_container>(&c)) {
+                    if (index_ < array->values.size()) {
+                        return;
+                    }
+                } else if (const auto *bitmap =
+                                   std::get_if<bitmap_container>(&c)) {
+                    for (; index_ < Chunk_Bits; index_ = (index_ | 63) + 1) {
+                        const auto word = bitmap->words[index_ / 64] >>
+                                (index_ % 64);
+                        if (word != 0) {
+                            index_ += static_cast<std::size_t>(
+                                    std::countr_zero(word));
+                            return;
+                        }
+                    }
+                } else if (index_ <
+                        std::get<run_container>(c).runs.size()) {
+                    return;
+                }
+            }
+        }
+
+        static constexpr std::size_t Chunk_Bits = Chunk_Words * 64;
+
+        const_iterator(const compressed_bitmap *bitmap, std::size_t chunk)
+                : bitmap_{bitmap}, chunk_{chunk} {
+            settle();
+        }
+
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = compressed_bitmap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = value_type;
+
+        const_iterator() = default;
+
+        value_type operator*() const {
+            const auto &c = current();
+            std::size_t value{};
+            if (const auto *array = std::get_if<array_container>(&c)) {
+                value = array->values[index_];
+            } else if (std::holds_alternative<bitmap_container>(c)) {
+                value = index_;
+            } else {
+                value = std::get<run_container>(c).runs[index_].start +
+                        offset_;
+            }
+            return static_cast<value_type>(
+                    (std::size_t{bitmap_->keys_[chunk_]} << 16) | value);
+        }
+
+        const_iterator &operator++() {
+            const auto &c = current();
+            if (const auto *runs = std::get_if<run_container>(&c)) {
+                const auto &r = runs->runs[index_];
+                if (r.start + offset_ < r.last) {
+                    ++offset_;
+                    return *this;
+                }
+                offset_ = 0;
+            }
+            ++index_;
+            settle();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return chunk_ == other.chunk_ && index_ == other.index_ &&
+                    offset_ == other.offset_;
+        }
+    };
+
+    using iterator = const_iterator;
+
+    compressed_bitmap() = default;
+
+    compressed_bitmap(std::initializer_list<value_type> values) {
+        for (const auto value : values) {
+            add(value);
+        }
+    }
+
+    void add(const value_type value) {
+        const auto key = high(value);
+        const auto idx = find(key);
+        if (idx == keys_.size() || keys_[idx] != key) {
+            keys_.insert(keys_.begin() + static_cast<std::ptrdiff_t>(idx), key);
+            containers_.insert(
+                    containers_.begin() + static_cast<std::ptrdiff_t>(idx),
+                    array_container{});
+        }
+        add(containers_[idx], low(value));
+    }
+
+    // Adds [first, last), the chunks it covers whole become single runs
+    void add_range(const std::uint64_t first, std::uint64_t last) {
+        last = std::min<std::uint64_t>(last, std::uint64_t{1} << 32);
+        for (auto begin = first; begin < last;) {
+            const auto key = static_cast<std::uint16_t>(begin >> 16);
+            const auto end = std::min(last, (begin | 0xffff) + 1);
+            const run r{static_cast<std::uint16_t>(begin),
+                    static_cast<std::uint16_t>(end - 1)};
+            const auto idx = find(key);
+            if (idx == keys_.size() || keys_[idx] != key) {
+                keys_.insert(
+                        keys_.begin() + static_cast<std::ptrdiff_t>(idx), key);
+                containers_.insert(
+                        containers_.begin() + static_cast<std::ptrdiff_t>(idx),
+                        run_container{{r}});
+            } else if (auto *runs =
+                               std::get_if<run_container>(&containers_[idx])) {
+                add_run(*runs, r);
+            } else {
+                auto bitmap = to_bitmap(containers_[idx]);
+                set_range(bitmap.words, r.start, r.last);
+                bitmap.cardinality =
+                        popcount_words(bitmap.words.data(), Chunk_Words);
+                containers_[idx] = shrink(std::move(bitmap));
+            }
+            begin = end;
+        }
+    }
+
+    void remove(const value_type value) {
+        const auto key = high(value);
+        const auto idx = find(key);
+        if (idx == keys_.size() || keys_[idx] != key) {
+            return;
+        }
+        remove(containers_[idx], low(value));
+        if (cardinality(containers_[idx]) == 0) {
+            keys_.erase(keys_.begin() + static_cast<std::ptrdiff_t>(idx));
+            containers_.erase(
+                    containers_.begin() + static_cast<std::ptrdiff_t>(idx));
+        }
+    }
+
+    [[nodiscard]] bool contains(const value_type value) const {
+        const auto key = high(value);
+        const auto idx = find(key);
+        return idx != keys_.size() && keys_[idx] == key &&
+                contains(containers_[idx], low(value));
+    }
+
+    // Number of values
+    [[nodiscard]] size_type cardinality() const noexcept {
+        std::size_t count{};
+        for (const auto &c : containers_) {
+            count += cardinality(c);
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return keys_.empty();
+    }
+
+    void clear() noexcept {
+        keys_.clear();
+        containers_.clear();
+    }
+
+    // Turns the chunks whose runs take less room than their array or
+    // bitmap into run lists, and back
+    void run_optimize() {
+        for (auto &c : containers_) {
+            c = fit(std::move(c));
+        }
+    }
+
+    // Bytes taken by the values, bookkeeping left out
+    [[nodiscard]] size_type size_in_bytes() const noexcept {
+        auto bytes = keys_.size() * sizeof(std::uint16_t);
+        for (const auto &c : containers_) {
+            bytes += size_in_bytes(c);
+        }
+        return bytes;
+    }
+
+    template <typename Func>
+    void for_each(Func &&func) const {
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            const auto key = value_type{keys_[i]} << 16;
+            for_each(containers_[i],
+                    [&](std::uint16_t value) { func(key | value); });
+        }
+    }
+
+    const_iterator begin() const {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const {
+        return const_iterator{this, containers_.size()};
+    }
+
+    bool operator==(const compressed_bitmap &other) const {
+        return keys_ == other.keys_ &&
+                cardinality() == other.cardinality() &&
+                std::equal(begin(), end(), other.begin());
+    }
+
+    friend compressed_bitmap operator&(
+            const compressed_bitmap &a, const compressed_bitmap &b) {
+        return merge<false, false>(a, b, and_containers);
+    }
+
+    friend compressed_bitmap operator|(
+            const compressed_bitmap &a, const compressed_bitmap &b) {
+        return merge<true, true>(a, b, or_containers);
+    }
+
+    // Values of a not in b
+    friend compressed_bitmap operator-(
+            const compressed_bitmap &a, const compressed_bitmap &b) {
+        return merge<true, false>(a, b, andnot_containers);
+    }
+
+    friend compressed_bitmap operator^(
+            const compressed_bitmap &a, const compressed_bitmap &b) {
+        return merge<true, true>(a, b, xor_containers);
+    }
+
+    compressed_bitmap &operator&=(const compressed_bitmap &other) {
+        return *this = *this & other;
+    }
+
+    compressed_bitmap &operator|=(const compressed_bitmap &other) {
+        return *this = *this | other;
+    }
+
+    compressed_bitmap &operator-=(const compressed_bitmap &other) {
+        return *this = *this - other;
+    }
+
+    compressed_bitmap &operator^=(const compressed_bitmap &other) {
+        return *this = *this ^ other;
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Compile-time description of a packed protocol header
+ *  jtl::layout<jtl::field<"ver", 4>, jtl::field<"ihl", 4>, ...> lays the
+ *  fields out back to back in network order, the first field taking the
+ *  most significant bits of the first byte. Offsets and widths are
+ *  constants, so get/set and the whole-header parse/deparse touch the
+ *  bytes of a buffer directly, with no intermediate bitset and loops the
+ *  compiler unrolls
+ */
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+// String literal usable as a template argument
+template <std::size_t N>
+struct fixed_string {
+    char value[N]{};
+
+    constexpr fixed_string(const char (&str)[N]) {
+        std::copy_n(str, N, value);
+    }
+
+    template <std::size_t M>
+    constexpr bool operator==(const fixed_string<M> &other) const {
+        return std::equal(value, value + N, other.value, other.value + M);
+    }
+};
+
+template <fixed_string Name, std::size_t Bits>
+struct field {
+    static_assert(Bits > 0, "empty fields are not supported");
+
+    static constexpr auto name = Name;
+    static constexpr std::size_t bits = Bits;
+    using value_type = std::bitset<Bits>;
+};
+
+// Reads count <= 64 bits starting offset bits after the most significant
+// bit of buf[0], going from the last byte of the field to the first
+constexpr std::uint64_t read_bits(std::span<const std::byte> buf,
+        const std::size_t offset, const std::size_t count) {
+    std::uint64_t value{};
+    std::size_t done{};
+    for (auto end = offset + count; done < count;) {
+        const auto shift = (8 - end % 8) % 8;
+        const auto bits = std::min(count - done, 8 - shift);
+        const auto byte = std::to_integer<std::uint64_t>(buf[(end - 1) / 8]);
+        value |= ((byte >> shift) & low_mask(bits)) << done;
+        done += bits;
+        end -= bits;
+    }
+    return value;
+}
+
+// Overwrites count <= 64 bits, bits of the bytes outside of the field are
+// kept
+constexpr void write_bits(std::span<std::byte> buf, const std::size_t offset,
+        const std::size_t count, std::uint64_t value) {
+    std::size_t done{};
+    for (auto end = offset + count; done < count;) {
+        const auto shift = (8 - end % 8) % 8;
+        const auto bits = std::min(count - done, 8 - shift);
+        const auto mask = static_cast<std::uint8_t>(low_mask(bits) << shift);
+        auto &byte = buf[(end - 1) / 8];
+        byte = (byte & std::byte{static_cast<std::uint8_t>(~mask)}) |
+                std::byte{static_cast<std::uint8_t>((value << shift) & mask)};
+        value >>= bits;
+        done += bits;
+        end -= bits;
+    }
+}
+
+template <typename... Fields>
+class layout {
+    static_assert(sizeof...(Fields) > 0, "a layout needs at least a field");
+
+    static constexpr std::array Widths{Fields::bits...};
+
+    static constexpr auto Offsets = [] {
+        std::array<std::size_t, sizeof...(Fields)> offsets{};
+        for (std::size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] = offsets[i - 1] + Widths[i - 1];
+        }
+        return offsets;
+    }();
+
+    template <fixed_string Name>
+    static constexpr std::size_t find() {
+        constexpr std::array Matches{(Fields::name == Name)...};
+        static_assert(std::count(Matches.begin(), Matches.end(), true) == 1,
+                "field names must match exactly one field");
+        return static_cast<std::size_t>(
+                std::find(Matches.begin(), Matches.end(), true) -
+                Matches.begin());
+    }
+
+    template <std::size_t Index>
+    static constexpr auto read(std::span<const std::byte> buf) {
+        constexpr auto Offset = Offsets[Index];
+        constexpr auto Bits = Widths[Index];
+        if constexpr (Bits <= UINT64_BIT_WIDTH) {
+            return std::bitset<Bits>{read_bits(buf, Offset, Bits)};
+        } else {
+            // Limbs are least significant first, the field ends at the
+            // least significant bit
+            words_t<Bits> words{};
+            for (std::size_t i = 0; i < words.size(); ++i) {
+                const auto done = i * UINT64_BIT_WIDTH;
+                const auto count =
+                        std::min<std::size_t>(UINT64_BIT_WIDTH, Bits - done);
+                words[i] = read_bits(buf, Offset + Bits - done - count, count);
+            }
+            return from_words<Bits>(words);
+        }
+    }
+
+    template <std::size_t Index>
+    static constexpr void write(std::span<std::byte> buf,
+            const std::bitset<Widths[Index]> &value) {
+        constexpr auto Offset = Offsets[Index];
+        constexpr auto Bits = Widths[Index];
+        const auto words = to_words(value);
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            const auto done = i * UINT64_BIT_WIDTH;
+            const auto count =
+                    std::min<std::size_t>(UINT64_BIT_WIDTH, Bits - done);
+            write_bits(buf, Offset + Bits - done - count, count, words[i]);
+        }
+    }
+
+    static constexpr void check_size(const std::size_t size) {
+        if (size < Size_Bytes) {
+            throw std::out_of_range("layout: buffer shorter than the header");
+        }
+    }
+
+ public:
+    using value_type = std::tuple<typename Fields::value_type...>;
+
+    static constexpr std::size_t Size_Bits = jtl::sum(Fields::bits...);
+    static constexpr std::size_t Size_Bytes = (Size_Bits + 7) / 8;
+
+    template <fixed_string Name>
+    static constexpr std::size_t Index = find<Name>();
+
+    // Bit offset from the most significant bit of the first byte
+    template <fixed_string Name>
+    static constexpr std::size_t Offset = Offsets[Index<Name>];
+
+    template <fixed_string Name>
+    static constexpr std::size_t Width = Widths[Index<Name>];
+
+    // Like operator[], get and set don't check the buffer size
+    template <fixed_string Name>
+    static constexpr auto get(std::span<const std::byte> buf) {
+        return read<Index<Name>>(buf);
+    }
+
+    template <fixed_string Name>
+    static constexpr void set(
+            std::span<std::byte> buf, const std::bitset<Width<Name>> &value) {
+        write<Index<Name>>(buf, value);
+    }
+
+    static constexpr value_type parse(std::span<const std::byte> buf) {
+        check_size(buf.size());
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return value_type{read<I>(buf)...};
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    static constexpr void deparse(std::span<std::byte> buf,
+            const typename Fields::value_type &...values) {
+        check_size(buf.size());
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (write<I>(buf, values), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    static constexpr void deparse(
+            std::span<std::byte> buf, const value_type &values) {
+        std::apply([&](const auto &...fields) { deparse(buf, fields...); },
+                values);
+    }
+
+    // Same bits as jtl::concat of the parsed fields
+    static constexpr auto to_bitset(std::span<const std::byte> buf) {
+        return std::apply(
+                [](const auto &...fields) { return concat(fields...); },
+                parse(buf));
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Array of Bits wide unsigned integers stored back to back
+ *  Element i lives at bit i * Bits of a vector of 64-bit words and may
+ *  straddle two of them, so n elements take n * Bits / 8 bytes rounded
+ *  up to a word. Elements are read and written with the shift and mask
+ *  helpers behind jtl::range. Mutable access goes through a proxy
+ *  reference, values wider than Bits are truncated as std::bitset does
+ */
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+template <std::size_t Bits, typename Alloc = std::allocator<std::uint64_t>>
+class packed_vector {
+    static_assert(Bits >= 1 && Bits <= UINT64_BIT_WIDTH,
+            "packed_vector: 1 to 64 bits per element");
+
+    static constexpr std::uint64_t Mask = low_mask(Bits);
+    // An element fits in the 8 bytes starting at its first byte
+    static constexpr bool Byte_Window =
+            Bits <= 57 && std::endian::native == std::endian::little;
+
+ public:
+    using value_type = std::uint64_t;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Alloc;
+
+    static constexpr std::size_t Element_Bits = Bits;
+
+    class reference {
+        friend class packed_vector;
+
+        std::uint64_t *words_;
+        size_type index_;
+
+        reference(std::uint64_t *words, const size_type index) noexcept
+                : words_{words}, index_{index} {}
+
+     public:
+        reference(const reference &) = default;
+
+        operator value_type() const noexcept {
+            return extract(words_, index_ * Bits, Bits);
+        }
+
+        reference &operator=(const value_type value) noexcept {
+            store(words_, index_ * Bits, value, Bits);
+            return *this;
+        }
+
+        // Assigns the element, not the proxy
+        reference &operator=(const reference &other) noexcept {
+            return *this = static_cast<value_type>(other);
+        }
+
+        // Wraps around modulo 2^Bits
+        reference &operator+=(const value_type value) noexcept {
+            return *this = static_cast<value_type>(*this) + value;
+        }
+
+        reference &operator-=(const value_type value) noexcept {
+            return *this = static_cast<value_type>(*this) - value;
+        }
+
+        reference &operator++() noexcept {
+            return *this += 1;
+        }
+
+        reference &operator--() noexcept {
+            return *this -= 1;
+        }
+
+        friend void swap(reference lhs, reference rhs) noexcept {
+            const value_type value = lhs;
+            lhs = static_cast<value_type>(rhs);
+            rhs = value;
+        }
+    };
+
+    template <bool Const>
+    class basic_iterator {
+     public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<Const, value_type,
+                typename packed_vector::reference>;
+
+     private:
+        friend class packed_vector;
+
+        using words_pointer = std::conditional_t<Const,
+                const std::uint64_t *, std::uint64_t *>;
+
+        words_pointer words_{nullptr};
+        difference_type index_{};
+
+        basic_iterator(words_pointer words, const difference_type index)
+                : words_{words}, index_{index} {}
+
+     public:
+        basic_iterator() = default;
+
+        // iterator to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false> &it)
+                : words_{it.words_}, index_{it.index_} {}
+
+        reference operator*() const {
+            if constexpr (Const) {
+                return extract(words_, static_cast<size_type>(index_) * Bits,
+                        Bits);
+            } else {
+                return reference{words_, static_cast<size_type>(index_)};
+            }
+        }
+
+        reference operator[](const difference_type n) const {
+            return *(*this + n);
+        }
+
+        basic_iterator &operator++() {
+            return (++index_, *this);
+        }
+        basic_iterator operator++(int) {
+            auto ret = *this;
+            ++index_;
+            return ret;
+        }
+
+        basic_iterator &operator--() {
+            return (--index_, *this);
+        }
+        basic_iterator operator--(int) {
+            auto ret = *this;
+            --index_;
+            return ret;
+        }
+
+        basic_iterator &operator+=(const difference_type inc) {
+            return (index_ += inc, *this);
+        }
+        basic_iterator &operator-=(const difference_type inc) {
+            return (index_ -= inc, *this);
+        }
+
+        friend basic_iterator operator+(
+                basic_iterator it, const difference_type offset) {
+            return it += offset;
+        }
+        friend basic_iterator operator+(
+                const difference_type offset, basic_iterator it) {
+            return it += offset;
+        }
+        friend basic_iterator operator-(
+                basic_iterator it, const difference_type offset) {
+            return it -= offset;
+        }
+        friend difference_type operator-(
+                const basic_iterator &lhs, const basic_iterator &rhs) {
+            return lhs.index_ - rhs.index_;
+        }
+
+        bool operator==(const basic_iterator &) const = default;
+        auto operator<=>(const basic_iterator &) const = default;
+
+        friend class basic_iterator<!Const>;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+ private:
+    std::vector<std::uint64_t, Alloc> words_;
+    size_type size_{};
+
+    static constexpr size_type words_for(const size_type n) noexcept {
+        return (n * Bits + UINT64_BIT_WIDTH - 1) / UINT64_BIT_WIDTH;
+    }
+
+    void check_run(const size_type first, const size_type count) const {
+        if (first > size_ || count > size_ - first) {
+            throw std::out_of_range("packed_vector: run past the end");
+        }
+    }
+
+ public:
+    packed_vector() = default;
+
+    explicit packed_vector(const Alloc &alloc) : words_(alloc) {}
+
+    explicit packed_vector(const size_type count, const value_type value = 0,
+            const Alloc &alloc = Alloc())
+            : words_(alloc) {
+        resize(count, value);
+    }
+
+    packed_vector(std::initializer_list<value_type> init,
+            const Alloc &alloc = Alloc())
+            : words_(alloc) {
+        resize(init.size());
+        set(0, std::span<const value_type>{init.begin(), init.size()});
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return words_.capacity() * UINT64_BIT_WIDTH / Bits;
+    }
+
+    // Bytes held by the elements, the allocation may be larger
+    [[nodiscard]] size_type size_in_bytes() const noexcept {
+        return words_.size() * sizeof(std::uint64_t);
+    }
+
+    // Largest value an element can hold
+    [[nodiscard]] static constexpr value_type max_value() noexcept {
+        return Mask;
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const {
+        return words_.get_allocator();
+    }
+
+    // The packed words, bits past the last element are zero
+    [[nodiscard]] const std::uint64_t *data() const noexcept {
+        return words_.data();
+    }
+
+    void reserve(const size_type count) {
+        words_.reserve(words_for(count));
+    }
+
+    void shrink_to_fit() {
+        words_.shrink_to_fit();
+    }
+
+    void clear() noexcept {
+        words_.clear();
+        size_ = 0;
+    }
+
+    void resize(const size_type count, const value_type value = 0) {
+        const auto old_size = size_;
+        words_.resize(words_for(count));
+        size_ = count;
+        if (count < old_size) {
+            if (const auto tail = count * Bits % UINT64_BIT_WIDTH; tail != 0) {
+                words_.back() &= low_mask(tail);
+            }
+            return;
+        }
+        if ((value & Mask) != 0) {
+            for (auto i = old_size; i < count; ++i) {
+                store(words_.data(), i * Bits, value, Bits);
+            }
+        }
+    }
+
+    void push_back(const value_type value) {
+        if (words_for(size_ + 1) > words_.size()) {
+            words_.push_back(0);
+        }
+        store(words_.data(), size_ * Bits, value, Bits);
+        ++size_;
+    }
+
+    void pop_back() noexcept {
+        --size_;
+        store(words_.data(), size_ * Bits, 0, Bits);
+        words_.resize(words_for(size_));
+    }
+
+    reference operator[](const size_type pos) noexcept {
+        return reference{words_.data(), pos};
+    }
+
+    value_type operator[](const size_type pos) const noexcept {
+        return extract(words_.data(), pos * Bits, Bits);
+    }
+
+    reference at(const size_type pos) {
+        if (pos >= size_) {
+            throw std::out_of_range("packed_vector: at");
+        }
+        return (*this)[pos];
+    }
+
+    [[nodiscard]] value_type at(const size_type pos) const {
+        if (pos >= size_) {
+            throw std::out_of_range("packed_vector: at");
+        }
+        return (*this)[pos];
+    }
+
+    reference front() noexcept {
+        return (*this)[0];
+    }
+    [[nodiscard]] value_type front() const noexcept {
+        return (*this)[0];
+    }
+
+    reference back() noexcept {
+        return (*this)[size_ - 1];
+    }
+    [[nodiscard]] value_type back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    // Copies out.size() elements starting at first into out. Elements
+    // are independent unaligned loads of the 8 bytes holding them, so
+    // consecutive ones don't wait on each other
+    template <std::unsigned_integral U, std::size_t Extent>
+    void get(const size_type first, std::span<U, Extent> out) const {
+        check_run(first, out.size());
+        size_type i{};
+        if constexpr (Byte_Window) {
+            const auto *bytes =
+                    reinterpret_cast<const unsigned char *>(words_.data());
+            // Elements whose window ends inside the words
+            const auto windows =
+                    (words_.size() * UINT64_BIT_WIDTH - UINT64_BIT_WIDTH) /
+                            Bits + 1;
+            const auto fast = std::min<size_type>(out.size(),
+                    windows > first ? windows - first : 0);
+            for (; i < fast; ++i) {
+                const auto offset = (first + i) * Bits;
+                std::uint64_t window;
+                std::memcpy(&window, bytes + offset / 8, sizeof(window));
+                out[i] = static_cast<U>((window >> (offset % 8)) & Mask);
+            }
+        }
+        for (; i < out.size(); ++i) {
+            out[i] = static_cast<U>(
+                    extract(words_.data(), (first + i) * Bits, Bits));
+        }
+    }
+
+    // Overwrites in.size() elements starting at first with in
+    template <typename U, std::size_t Extent>
+        requires std::unsigned_integral<std::remove_const_t<U>>
+    void set(const size_type first, std::span<U, Extent> in) {
+        check_run(first, in.size());
+        auto *words = words_.data();
+        auto word = first * Bits / UINT64_BIT_WIDTH;
+        auto bit = first * Bits % UINT64_BIT_WIDTH;
+        for (const auto element : in) {
+            const auto value = static_cast<std::uint64_t>(element) & Mask;
+            words[word] = (words[word] & ~(Mask << bit)) | (value << bit);
+            bit += Bits;
+            if (bit >= UINT64_BIT_WIDTH) {
+                bit -= UINT64_BIT_WIDTH;
+                ++word;
+                if (bit != 0) {
+                    words[word] = (words[word] & ~low_mask(bit)) |
+                            (value >> (Bits - bit));
+                }
+            }
+        }
+    }
+
+    iterator begin() noexcept {
+        return iterator{words_.data(), 0};
+    }
+    iterator end() noexcept {
+        return iterator{words_.data(), static_cast<difference_type>(size_)};
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator{words_.data(), 0};
+    }
+    const_iterator end() const noexcept {
+        return const_iterator{
+                words_.data(), static_cast<difference_type>(size_)};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator{end()};
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator{begin()};
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator{end()};
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator{begin()};
+    }
+
+    // Bits past the last element being zero, equal words mean equal
+    // elements
+    friend bool operator==(
+            const packed_vector &lhs, const packed_vector &rhs) noexcept {
+        return lhs.size_ == rhs.size_ && lhs.words_ == rhs.words_;
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Immutable bitvector answering rank and select queries
+ *  The directory has two levels: an absolute 64-bit count every 2^16
+ *  bits and a 16-bit count, relative to it, every 512 bits, about 3.2%
+ *  on top of the bits. rank1 adds both to the popcount of at most eight
+ *  words. select1 keeps the block holding every 8192th one, binary
+ *  searches the blocks between two samples and finishes inside a word
+ *  with pdep
+ */
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+// Position of the one of rank r, counting from the least significant bit
+inline std::size_t select_in_word(
+        const std::uint64_t word, const std::size_t r) {
+    return static_cast<std::size_t>(
+            std::countr_zero(deposit_bits(std::uint64_t{1} << r, word)));
+}
+
+class rank_select_bitvector {
+    static constexpr std::size_t Block_Bits = 512;
+    static constexpr std::size_t Block_Words = Block_Bits / UINT64_BIT_WIDTH;
+    static constexpr std::size_t Super_Bits = std::size_t{1} << 16;
+    static constexpr std::size_t Super_Blocks = Super_Bits / Block_Bits;
+    static constexpr std::size_t Select_Sample = 8192;
+
+    std::vector<std::uint64_t> words_;
+    std::size_t size_{};
+    std::size_t ones_{};
+    std::vector<std::uint64_t> super_rank_;
+    std::vector<std::uint16_t> block_rank_;
+    // Block holding the one of rank i * Select_Sample
+    std::vector<std::uint64_t> select_samples_;
+
+    std::size_t blocks() const noexcept {
+        return block_rank_.size();
+    }
+
+    std::size_t block_rank(const std::size_t block) const noexcept {
+        return super_rank_[block / Super_Blocks] + block_rank_[block];
+    }
+
+    void build() {
+        words_.resize((size_ + UINT64_BIT_WIDTH - 1) / UINT64_BIT_WIDTH);
+        if (const auto tail = size_ % UINT64_BIT_WIDTH; tail != 0) {
+            words_.back() &= low_mask(tail);
+        }
+        const auto num_blocks = (words_.size() + Block_Words - 1) / Block_Words;
+        super_rank_.reserve((num_blocks + Super_Blocks - 1) / Super_Blocks);
+        block_rank_.resize(num_blocks);
+        std::size_t next_sample{};
+        for (std::size_t block = 0; block < num_blocks; ++block) {
+            if (block % Super_Blocks == 0) {
+                super_rank_.push_back(ones_);
+            }
+            block_rank_[block] =
+                    static_cast<std::uint16_t>(ones_ - super_rank_.back());
+            const auto first = block * Block_Words;
+            ones_ += popcount_words(words_.data() + first,
+                    std::min(Block_Words, words_.size() - first));
+            for (; next_sample < ones_; next_sample += Select_Sample) {
+                select_samples_.push_back(block);
+            }
+        }
+    }
+
+ public:
+    using size_type = std::size_t;
+
+    rank_select_bitvector() = default;
+
+    // Bits past size in the last word are ignored
+    rank_select_bitvector(std::vector<std::uint64_t> words, size_type size)
+            : words_{std::move(words)}, size_{size} {
+        if (words_.size() * UINT64_BIT_WIDTH < size_) {
+            throw std::invalid_argument(
+                    "rank_select_bitvector: fewer words than bits");
+        }
+        build();
+    }
+
+    template <std::size_t N>
+    explicit rank_select_bitvector(const std::bitset<N> &bs) : size_{N} {
+        const auto words = to_words(bs);
+        words_.assign(words.begin(), words.end());
+        build();
+    }
+
+    // Bitvector of size bits where the positions in ones are set
+    template <std::ranges::input_range Range>
+    rank_select_bitvector(size_type size, Range &&ones)
+            : words_((size + UINT64_BIT_WIDTH - 1) / UINT64_BIT_WIDTH),
+              size_{size} {
+        for (const auto pos : ones) {
+            if (static_cast<size_type>(pos) >= size_) {
+                throw std::out_of_range(
+                        "rank_select_bitvector: position past the end");
+            }
+            words_[pos / UINT64_BIT_WIDTH] |= std::uint64_t{1}
+                    << (pos % UINT64_BIT_WIDTH);
+        }
+        build();
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    // Number of ones
+    [[nodiscard]] size_type count() const noexcept {
+        return ones_;
+    }
+
+    [[nodiscard]] bool operator[](const size_type pos) const noexcept {
+        return ((words_[pos / UINT64_BIT_WIDTH] >> (pos % UINT64_BIT_WIDTH)) &
+                       1) != 0;
+    }
+
+    [[nodiscard]] bool test(const size_type pos) const {
+        if (pos >= size_) {
+            throw std::out_of_range("rank_select_bitvector: test");
+        }
+        return (*this)[pos];
+    }
+
+    // Ones in [0, pos), pos <= size()
+    [[nodiscard]] size_type rank1(const size_type pos) const noexcept {
+        if (pos >= size_) {
+            return ones_;
+        }
+        const auto block = pos / Block_Bits;
+        const auto word = pos / UINT64_BIT_WIDTH;
+        const auto first = block * Block_Words;
+        return block_rank(block) +
+                popcount_words(words_.data() + first, word - first) +
+                popcount_word(words_[word] & low_mask(pos % UINT64_BIT_WIDTH));
+    }
+
+    // Zeros in [0, pos), pos <= size()
+    [[nodiscard]] size_type rank0(const size_type pos) const noexcept {
+        return std::min(pos, size_) - rank1(pos);
+    }
+
+    // Position of the one of rank k, counting from 0
+    [[nodiscard]] size_type select1(size_type k) const {
+        if (k >= ones_) {
+            throw std::out_of_range("rank_select_bitvector: select1");
+        }
+        const auto sample = k / Select_Sample;
+        const auto first = select_samples_[sample];
+        const auto last = sample + 1 < select_samples_.size()
+                ? select_samples_[sample + 1] + 1
+                : blocks();
+        // Last block starting at rank <= k
+        auto lo = first;
+        auto hi = last;
+        while (hi - lo > 1) {
+            const auto mid = lo + (hi - lo) / 2;
+            if (block_rank(mid) <= k) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        k -= block_rank(lo);
+        for (auto word = lo * Block_Words;; ++word) {
+            const auto ones = popcount_word(words_[word]);
+            if (k < ones) {
+                return word * UINT64_BIT_WIDTH +
+                        select_in_word(words_[word], k);
+            }
+            k -= ones;
+        }
+    }
+
+    [[nodiscard]] const std::vector<std::uint64_t> &words() const noexcept {
+        return words_;
+    }
+
+    // Bits plus directory
+    [[nodiscard]] size_type size_in_bytes() const noexcept {
+        return words_.size() * sizeof(std::uint64_t) +
+                super_rank_.size() * sizeof(std::uint64_t) +
+                block_rank_.size() * sizeof(std::uint16_t) +
+                select_samples_.size() * sizeof(std::uint64_t);
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Value/mask match table, the software counterpart of a TCAM
+ *  Lookups use tuple space search: entries sharing a mask form a tuple,
+ *  a hash table from masked value to entries. A key is masked and
+ *  looked up once per tuple, tuples being visited by decreasing best
+ *  priority so the search stops as soon as no remaining tuple can beat
+ *  the match found. Keys are std::bitset<KeyBits>, as built by
+ *  jtl::concat. Overlapping entries of equal priority match in no
+ *  particular order
+ */
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bitset.hpp"
+
+namespace jtl {
+
+template <std::size_t KeyBits, typename Action>
+class ternary_table {
+ public:
+    using key_type = std::bitset<KeyBits>;
+    using action_type = Action;
+    using priority_type = std::uint32_t;
+    using size_type = std::size_t;
+
+ private:
+    using words_type = words_t<KeyBits>;
+
+    struct words_hash {
+        std::size_t operator()(const words_type &words) const noexcept {
+            std::uint64_t hash{0x9e3779b97f4a7c15};
+            for (const auto word : words) {
+                hash = (hash ^ word) * 0xbf58476d1ce4e5b9;
+                hash ^= hash >> 31;
+            }
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    struct slot {
+        priority_type priority;
+        Action action;
+    };
+
+    // Slots by decreasing priority
+    using bucket = std::vector<slot>;
+
+    struct tuple {
+        words_type mask;
+        std::unordered_map<words_type, bucket, words_hash> entries;
+        std::multiset<priority_type> priorities;
+
+        priority_type best() const {
+            return *priorities.rbegin();
+        }
+    };
+
+    std::vector<tuple> tuples_;
+    size_type size_{};
+
+    static words_type masked(const words_type &key, const words_type &mask) {
+        words_type result;
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result[i] = key[i] & mask[i];
+        }
+        return result;
+    }
+
+    typename std::vector<tuple>::iterator find_tuple(const words_type &mask) {
+        return std::find_if(tuples_.begin(), tuples_.end(),
+                [&](const tuple &t) { return t.mask == mask; });
+    }
+
+    void sort_tuples() {
+        std::stable_sort(tuples_.begin(), tuples_.end(),
+                [](const tuple &a, const tuple &b) {
+                    return a.best() > b.best();
+                });
+    }
+
+ public:
+    ternary_table() = default;
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Number of distinct masks, every lookup probes at most that many
+    // hash tables
+    [[nodiscard]] size_type tuple_count() const noexcept {
+        return tuples_.size();
+    }
+
+    void clear() noexcept {
+        tuples_.clear();
+        size_ = 0;
+    }
+
+    // Adds an entry matching the keys k with k & mask == value & mask.
+    // An entry with the same value, mask and priority gets its action
+    // replaced, in which case false is returned
+    bool insert(const key_type &value, const key_type &mask,
+            const priority_type priority, Action action) {
+        const auto mask_words = to_words(mask);
+        auto t = find_tuple(mask_words);
+        if (t == tuples_.end()) {
+            tuples_.push_back(tuple{mask_words, {}, {}});
+            t = std::prev(tuples_.end());
+        }
+        auto &slots = t->entries[masked(to_words(value), mask_words)];
+        auto pos = std::find_if(slots.begin(), slots.end(),
+                [&](const slot &s) { return s.priority <= priority; });
+        if (pos != slots.end() && pos->priority == priority) {
+            pos->action = std::move(action);
+            return false;
+        }
+        slots.insert(pos, slot{priority, std::move(action)});
+        t->priorities.insert(priority);
+        ++size_;
+        sort_tuples();
+        return true;
+    }
+
+    // Removes the entry inserted with the same value, mask and priority
+    bool erase(const key_type &value, const key_type &mask,
+            const priority_type priority) {
+        const auto mask_words = to_words(mask);
+        const auto t = find_tuple(mask_words);
+        if (t == tuples_.end()) {
+            return false;
+        }
+        const auto entry = t->entries.find(masked(to_words(value), mask_words));
+        if (entry == t->entries.end()) {
+            return false;
+        }
+        auto &slots = entry->second;
+        const auto pos = std::find_if(slots.begin(), slots.end(),
+                [&](const slot &s) { return s.priority == priority; });
+        if (pos == slots.end()) {
+            return false;
+        }
+        slots.erase(pos);
+        if (slots.empty()) {
+            t->entries.erase(entry);
+        }
+        t->priorities.erase(t->priorities.find(priority));
+        --size_;
+        if (t->priorities.empty()) {
+            tuples_.erase(t);
+        } else {
+            sort_tuples();
+        }
+        return true;
+    }
+
+    // Action of the highest priority entry matching key, nullptr when
+    // none does
+    [[nodiscard]] const Action *lookup(const key_type &key) const {
+        const auto key_words = to_words(key);
+        const slot *best{};
+        for (const auto &t : tuples_) {
+            if (best != nullptr && t.best() <= best->priority) {
+                break;
+            }
+            const auto entry = t.entries.find(masked(key_words, t.mask));
+            if (entry != t.entries.end() &&
+                    (best == nullptr ||
+                            entry->second.front().priority > best->priority)) {
+                best = &entry->second.front();
+            }
+        }
+        return best == nullptr ? nullptr : &best->action;
+    }
+
+    // lookup for a batch of keys, best suited to a few dozens of them.
+    // Tuples are walked once for the whole batch instead of once per key
+    void lookup(std::span<const key_type> keys,
+            std::span<const Action *> actions) const {
+        if (keys.size() != actions.size()) {
+            throw std::length_error("ternary_table: batch sizes differ");
+        }
+        std::vector<words_type> key_words(keys.size());
+        std::vector<const slot *> best(keys.size());
+        std::transform(keys.begin(), keys.end(), key_words.begin(),
+                [](const key_type &key) { return to_words(key); });
+        auto pending = keys.size();
+        for (const auto &t : tuples_) {
+            if (pending == 0) {
+                break;
+            }
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                if (best[i] != nullptr && best[i]->priority >= t.best()) {
+                    continue;
+                }
+                const auto entry =
+                        t.entries.find(masked(key_words[i], t.mask));
+                if (entry == t.entries.end()) {
+                    continue;
+                }
+                const auto *candidate = &entry->second.front();
+                if (best[i] == nullptr ||
+                        candidate->priority > best[i]->priority) {
+                    best[i] = candidate;
+                }
+            }
+            // Keys whose match can't be beaten by the next tuples are done
+            const auto next_best = &t == &tuples_.back()
+                    ? priority_type{}
+                    : (&t + 1)->best();
+            pending = static_cast<std::size_t>(std::count_if(best.begin(),
+                    best.end(), [&](const slot *s) {
+                        return s == nullptr || s->priority < next_best;
+                    }));
+        }
+        std::transform(best.begin(), best.end(), actions.begin(),
+                [](const slot *s) {
+                    return s == nullptr ? nullptr : &s->action;
+                });
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,121 @@
+#include "bit_kernels.hpp"
+
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using words_t = std::vector<std::uint64_t>;
+
+// Every level the machine can run, the scalar one included
+static std::vector<jtl::simd_level> levels() {
+    std::vector<jtl::simd_level> result;
+    for (const auto level : {jtl::simd_level::scalar, jtl::simd_level::sse2,
+                 jtl::simd_level::avx2, jtl::simd_level::avx512}) {
+        if (level <= jtl::Simd_Level) {
+            result.push_back(level);
+        }
+    }
+    return result;
+}
+
+static words_t random_words(std::size_t count, std::mt19937_64 &gen) {
+    words_t words(count);
+    for (auto &word : words) {
+        word = gen();
+    }
+    return words;
+}
+
+// Sizes around every vector width, so that each tail path runs
+static constexpr std::size_t Sizes[] = {
+        0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1000};
+
+template <jtl::bit_op Op>
+static void check_combine(std::mt19937_64 &gen) {
+    for (const auto level : levels()) {
+        for (const auto size : Sizes) {
+            const auto a = random_words(size, gen);
+            const auto b = random_words(size, gen);
+            words_t dst(size);
+            jtl::combine_words<Op>(level, dst.data(), a.data(), b.data(), size);
+            for (std::size_t i = 0; i < size; ++i) {
+                ASSERT_EQ(dst[i], jtl::apply_op<Op>(a[i], b[i]));
+            }
+            // In place
+            auto in_place = a;
+            jtl::combine_words<Op>(level, in_place.data(), in_place.data(),
+                    b.data(), size);
+            ASSERT_EQ(in_place, dst);
+        }
+    }
+}
+
+TEST(BitKernelsTest, Combine) {
+    std::mt19937_64 gen{7};
+    check_combine<jtl::bit_op::and_op>(gen);
+    check_combine<jtl::bit_op::or_op>(gen);
+    check_combine<jtl::bit_op::xor_op>(gen);
+    check_combine<jtl::bit_op::andnot_op>(gen);
+}
+
+TEST(BitKernelsTest, CountOnes) {
+    std::mt19937_64 gen{11};
+    for (const auto size : Sizes) {
+        const auto words = random_words(size, gen);
+        std::size_t expected{};
+        for (const auto word : words) {
+            expected += static_cast<std::size_t>(std::popcount(word));
+        }
+        for (const auto level : levels()) {
+            EXPECT_EQ(jtl::count_ones_words(level, words.data(), size),
+                    expected);
+        }
+    }
+    const words_t full(37, ~std::uint64_t{});
+    EXPECT_EQ(jtl::count_ones(full), 37 * 64);
+}
+
+TEST(BitKernelsTest, FindFirst) {
+    for (const auto size : Sizes) {
+        words_t words(size);
+        EXPECT_TRUE(jtl::none(words) && !jtl::any(words));
+        EXPECT_EQ(jtl::find_first(words), size * 64);
+        for (std::size_t word = 0; word < size; word += 3) {
+            words.assign(size, 0);
+            words[word] = std::uint64_t{1} << (word % 64);
+            if (word + 1 < size) {
+                words[word + 1] = 1;
+            }
+            for (const auto level : levels()) {
+                EXPECT_EQ(jtl::first_word(level, words.data(), size), word);
+            }
+            EXPECT_EQ(jtl::find_first(words), word * 64 + word % 64);
+            EXPECT_TRUE(jtl::any(words));
+        }
+    }
+}
+
+TEST(BitKernelsTest, Spans) {
+    const words_t a{0xff00, 0x0f0f, 0x1};
+    const words_t b{0x0ff0, 0x00ff, 0x3};
+    words_t dst(3);
+    jtl::bitwise_and(dst, a, b);
+    EXPECT_EQ(dst, (words_t{0x0f00, 0x000f, 0x1}));
+    jtl::bitwise_or(dst, a, b);
+    EXPECT_EQ(dst, (words_t{0xfff0, 0x0fff, 0x3}));
+    jtl::bitwise_xor(dst, a, b);
+    EXPECT_EQ(dst, (words_t{0xf0f0, 0x0ff0, 0x2}));
+    jtl::bitwise_andnot(dst, a, b);
+    EXPECT_EQ(dst, (words_t{0xf000, 0x0f00, 0x0}));
+    words_t short_dst(2);
+    EXPECT_THROW(jtl::bitwise_and(short_dst, a, b), std::length_error);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
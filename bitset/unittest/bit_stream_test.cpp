@@ -0,0 +1,156 @@
+#include "bit_stream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+template <typename... Bytes>
+static constexpr auto bytes(Bytes... values) {
+    return std::array{std::byte{static_cast<std::uint8_t>(values)}...};
+}
+
+TEST(BitStreamTest, ReadMsbFirst) {
+    constexpr auto buf = bytes(0x45, 0x00, 0x00, 0x54, 0x1c, 0x46, 0x40,
+            0x00, 0x40, 0x01);
+    jtl::bit_reader reader{buf};
+    EXPECT_EQ(reader.read(4), 4);
+    EXPECT_EQ(reader.read(4), 5);
+    EXPECT_EQ(reader.read(8), 0);
+    EXPECT_EQ(reader.peek(16), 0x54);
+    EXPECT_EQ(reader.read(16), 0x54);
+    EXPECT_EQ(reader.read(16), 0x1c46);
+    EXPECT_EQ(reader.read(3), 2);
+    EXPECT_EQ(reader.read(13), 0);
+    EXPECT_EQ(reader.position(), 64);
+    EXPECT_EQ(reader.read(16), 0x4001);
+    EXPECT_EQ(reader.remaining(), 0);
+    EXPECT_THROW(reader.read(1), std::out_of_range);
+}
+
+TEST(BitStreamTest, ReadLsbFirst) {
+    constexpr auto buf = bytes(0b1011'0101, 0xff, 0x00, 0x12, 0x34);
+    jtl::bit_reader<jtl::bit_order::lsb_first> reader{buf};
+    EXPECT_EQ(reader.read(1), 1);
+    EXPECT_EQ(reader.read(2), 0b10);
+    EXPECT_EQ(reader.read(5), 0b10110);
+    EXPECT_EQ(reader.read(12), 0x0ff);
+    EXPECT_EQ(reader.read(20), 0x34120);
+    EXPECT_EQ(reader.remaining(), 0);
+}
+
+TEST(BitStreamTest, ReadConstexpr) {
+    constexpr auto fields = [] {
+        constexpr auto buf = bytes(0xde, 0xad, 0xbe, 0xef, 0x01, 0x23, 0x45,
+                0x67, 0x89, 0xab, 0xcd, 0xef);
+        jtl::bit_reader reader{buf};
+        const auto first = reader.read(12);
+        const auto second = reader.read(64);
+        return std::array{first, second, reader.read(20)};
+    }();
+    static_assert(fields[0] == 0xdea && fields[1] == 0xdbeef0123456789a &&
+            fields[2] == 0xbcdef);
+    EXPECT_TRUE(true);
+}
+
+TEST(BitStreamTest, WriteReadRoundTrip) {
+    std::vector<std::byte> buf(64);
+    const std::array widths{1, 7, 13, 64, 3, 56, 57, 33, 2, 63, 17, 64};
+    std::vector<std::uint64_t> values;
+    std::uint64_t value{0x9e3779b97f4a7c15};
+    for (const auto width : widths) {
+        values.push_back(value & jtl::low_mask(width));
+        value = value * 0x5851f42d4c957f2d + 1;
+    }
+    {
+        jtl::bit_writer writer{buf};
+        for (std::size_t i = 0; i < widths.size(); ++i) {
+            writer.write(values[i], widths[i]);
+        }
+    }
+    jtl::bit_reader reader{buf};
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+        EXPECT_EQ(reader.read(widths[i]), values[i]);
+    }
+
+    std::vector<std::byte> lsb_buf(64);
+    {
+        jtl::bit_writer<jtl::bit_order::lsb_first> writer{lsb_buf};
+        for (std::size_t i = 0; i < widths.size(); ++i) {
+            writer.write(values[i], widths[i]);
+        }
+    }
+    jtl::bit_reader<jtl::bit_order::lsb_first> lsb_reader{lsb_buf};
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+        EXPECT_EQ(lsb_reader.read(widths[i]), values[i]);
+    }
+}
+
+TEST(BitStreamTest, Bitsets) {
+    std::bitset<100> wide{0x0123'4567'89ab'cdef};
+    wide[99] = wide[70] = 1;
+    std::array<std::byte, 16> buf{};
+    {
+        jtl::bit_writer writer{buf};
+        writer.write(std::bitset<5>{0x15});
+        writer.write(wide);
+    }
+    jtl::bit_reader reader{buf};
+    EXPECT_EQ(reader.read<5>(), std::bitset<5>{0x15});
+    EXPECT_EQ(reader.read<100>(), wide);
+    // msb_first streams hold bitsets in their to_string order
+    jtl::bit_reader again{buf};
+    again.skip(5);
+    std::string str;
+    for (auto i = 0; i < 100; ++i) {
+        str += again.read(1) != 0 ? '1' : '0';
+    }
+    EXPECT_EQ(str, wide.to_string());
+}
+
+TEST(BitStreamTest, SkipAlign) {
+    constexpr auto buf = bytes(0xf0, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+            0x07, 0x08, 0x09, 0x0a, 0x0b);
+    jtl::bit_reader reader{buf};
+    reader.read(3);
+    reader.align();
+    EXPECT_EQ(reader.position(), 8);
+    reader.skip(60);
+    EXPECT_EQ(reader.read(12), 0x809);
+    EXPECT_THROW(reader.skip(17), std::out_of_range);
+}
+
+TEST(BitStreamTest, WriterKeepsTrailingBits) {
+    auto buf = bytes(0xff, 0xff);
+    {
+        jtl::bit_writer writer{buf};
+        writer.write(0, 4);
+        writer.write(0b101, 3);
+    }
+    EXPECT_TRUE(buf[0] == std::byte{0x0b} && buf[1] == std::byte{0xff});
+    jtl::bit_writer writer{buf};
+    writer.write(0x3, 2);
+    writer.align();
+    EXPECT_EQ(writer.position(), 8);
+    EXPECT_THROW(writer.write(0, 9), std::out_of_range);
+    writer.write_unchecked(0xabc, 12);
+    EXPECT_EQ(writer.remaining(), 0);
+    EXPECT_TRUE(buf[0] == std::byte{0xc0} && buf[1] == std::byte{0xab});
+}
+
+TEST(BitStreamTest, UncheckedPastTheEnd) {
+    constexpr auto buf = bytes(0xab);
+    jtl::bit_reader reader{buf};
+    EXPECT_EQ(reader.read_unchecked(12), 0xab0);
+    EXPECT_EQ(reader.read_unchecked(8), 0);
+    EXPECT_EQ(reader.remaining(), 0);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 
 #include <bitset>
+#include <stdexcept>
+#include <utility>
 
 TEST(BitsetTest, Concat) {
     constexpr std::bitset<1> bs1{1};
@@ -66,6 +68,68 @@ TEST(BitsetTest, ConcatSplitStr) {
     EXPECT_TRUE(bs1 == bs1_golden && bs2 == bs2_golden);
 }
 
+TEST(BitsetTest, ConcatWide) {
+    std::bitset<100> bs1{};
+    std::bitset<37> bs2{0x1234567};
+    std::bitset<128> bs3{};
+    bs1[99] = bs1[0] = 1;
+    bs3[127] = bs3[64] = bs3[3] = 1;
+    const auto golden = std::bitset<265>{
+            bs1.to_string() + bs2.to_string() + bs3.to_string()};
+    EXPECT_EQ(jtl::concat(bs1, bs2, bs3), golden);
+}
+
+TEST(BitsetTest, ConcatWordsConstexpr) {
+    constexpr std::bitset<60> bs1{0xabc};
+    constexpr std::bitset<64> bs2{~std::uint64_t{}};
+    constexpr std::bitset<8> bs3{0x5a};
+    constexpr auto words = jtl::concat_words(bs1, bs2, bs3);
+    static_assert(words[0] == 0xffff'ffff'ffff'ff5a &&
+            words[1] == (std::uint64_t{0xabc} << 8 | 0xff));
+    EXPECT_EQ(jtl::from_words<132>(words), jtl::concat(bs1, bs2, bs3));
+}
+
+TEST(BitsetTest, SplitWide) {
+    std::bitset<256> header{};
+    for (auto i = 0; i < 256; i += 3) {
+        header[i] = 1;
+    }
+    std::bitset<4> ver{};
+    std::bitset<4> ihl{};
+    std::bitset<8> tos{};
+    std::bitset<16> len{};
+    std::bitset<100> opts{};
+    std::bitset<65> tag{};
+    std::bitset<27> rest{};
+    std::bitset<32> crc{};
+    jtl::split(header, ver, ihl, tos, len, opts, tag, rest, crc);
+
+    // Same fields cut out of the string representation
+    const auto str = header.to_string();
+    EXPECT_TRUE(ver == std::bitset<4>{str.substr(0, 4)} &&
+            ihl == std::bitset<4>{str.substr(4, 4)} &&
+            tos == std::bitset<8>{str.substr(8, 8)} &&
+            len == std::bitset<16>{str.substr(16, 16)} &&
+            opts == std::bitset<100>{str.substr(32, 100)} &&
+            tag == std::bitset<65>{str.substr(132, 65)} &&
+            rest == std::bitset<27>{str.substr(197, 27)} &&
+            crc == std::bitset<32>{str.substr(224, 32)});
+}
+
+TEST(BitsetTest, SplitConstexpr) {
+    constexpr auto fields = [] {
+        std::bitset<4> bs1{};
+        std::bitset<40> bs2{};
+        std::bitset<20> bs3{};
+        jtl::split(std::bitset<64>{0xa'0123456789'bcdef}, bs1, bs2, bs3);
+        return std::array{jtl::to_uint64(bs1), jtl::to_uint64(bs2),
+                jtl::to_uint64(bs3)};
+    }();
+    static_assert(fields[0] == 0xa && fields[1] == 0x0123456789 &&
+            fields[2] == 0xbcdef);
+    EXPECT_TRUE(true);
+}
+
 TEST(BitsetTest, ConcatSingleParam) {
     constexpr std::bitset<1> bs1{1};
     EXPECT_EQ(jtl::concat(bs1), bs1);
@@ -102,6 +166,82 @@ TEST(BitsetTest, RangeStr) {
             range_result3 == decltype(bs_golden){1});
 }
 
+TEST(BitsetTest, RangeWide) {
+    std::bitset<200> bs{};
+    for (auto i = 0; i < 200; i += 7) {
+        bs[i] = 1;
+    }
+    const auto str = bs.to_string();
+    for (const auto &[offset, count] : {std::pair{0ul, 200ul},
+                 std::pair{3ul, 64ul}, std::pair{61ul, 70ul},
+                 std::pair{128ul, 72ul}, std::pair{199ul, 1ul}}) {
+        EXPECT_EQ(jtl::range(bs, offset, count),
+                std::bitset<200>{str.substr(200 - offset - count, count)});
+    }
+}
+
+TEST(BitsetTest, InsertRange) {
+    constexpr auto narrow =
+            jtl::insert_range(std::bitset<16>{0xffff}, 4, std::bitset<8>{0x5a});
+    static_assert(jtl::to_uint64(narrow) == 0xf5af);
+    std::bitset<150> bs{};
+    bs.set();
+    const auto field = std::bitset<70>{0x0123456789abcdef} << 3;
+    const auto result = jtl::insert_range(bs, 60, field);
+    EXPECT_EQ(jtl::range(result, 60, 70), std::bitset<150>{field.to_string()});
+    EXPECT_TRUE(jtl::range(result, 0, 60).count() == 60 &&
+            jtl::range(result, 130, 20).count() == 20);
+}
+
+TEST(BitsetTest, RangeOutOfBounds) {
+    const std::bitset<200> bs{};
+    EXPECT_THROW(jtl::range(bs, 150, 60), std::out_of_range);
+    EXPECT_THROW(jtl::range(bs, 0, 201), std::out_of_range);
+    EXPECT_THROW(jtl::range(bs, 201, 0), std::out_of_range);
+    EXPECT_THROW(jtl::range(bs, ~0ull, 2), std::out_of_range);
+    EXPECT_NO_THROW(jtl::range(bs, 200, 0));
+}
+
+TEST(BitsetTest, InsertRangePastEnd) {
+    // Bits landing past the end are dropped, far offsets change nothing
+    static_assert(jtl::to_uint64(jtl::insert_range(std::bitset<16>{0},
+                          12, std::bitset<8>{0xff})) == 0xf000);
+    static_assert(jtl::to_uint64(jtl::insert_range(std::bitset<16>{0x1234},
+                          64, std::bitset<8>{0xff})) == 0x1234);
+    static_assert(jtl::to_uint64(jtl::insert_range(std::bitset<64>{0},
+                          70, std::bitset<8>{0xff})) == 0);
+    std::bitset<130> bs{};
+    std::bitset<70> field{};
+    field.set();
+    const auto result = jtl::insert_range(bs, 100, field);
+    EXPECT_TRUE(result.count() == 30 &&
+            jtl::range(result, 100, 30).count() == 30);
+    EXPECT_EQ(jtl::insert_range(bs, 130, field), bs);
+    EXPECT_EQ(jtl::insert_range(bs, ~0ull, field), bs);
+}
+
+TEST(BitsetTest, ExtractDepositBits) {
+    constexpr std::uint64_t Mask = 0xf0f0'0000'0000'ff01;
+    static_assert(jtl::pext_portable(0xa050'0000'0000'3c01, Mask) == 0x14a79);
+    static_assert(jtl::pdep_portable(0x14a79, Mask) == 0xa050'0000'0000'3c01);
+    std::uint64_t value{1};
+    for (auto i = 0; i < 64; ++i, value = value * 3 + 1) {
+        EXPECT_EQ(jtl::extract_bits(value, Mask),
+                jtl::pext_portable(value, Mask));
+        EXPECT_EQ(jtl::deposit_bits(value, ~Mask),
+                jtl::pdep_portable(value, ~Mask));
+    }
+}
+
+TEST(BitsetTest, GatherScatter) {
+    constexpr std::bitset<16> bs{0b1010'0110'0000'1001};
+    constexpr auto flags = jtl::gather<0xf00f>(bs);
+    static_assert(jtl::to_uint64(flags) == 0b1010'1001);
+    const auto cleared = jtl::scatter<0xf00f>(bs, std::bitset<8>{});
+    EXPECT_TRUE(cleared == std::bitset<16>{0b0000'0110'0000'0000} &&
+            jtl::scatter<0xf00f>(cleared, flags) == bs);
+}
+
 int main(int argc, char *argv[]) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,175 @@
+#include "compressed_bitmap.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using values_t = std::vector<std::uint32_t>;
+
+static values_t values_of(const jtl::compressed_bitmap &bitmap) {
+    return values_t(bitmap.begin(), bitmap.end());
+}
+
+// Sparse chunks, chunks past the array limit and a long run
+static values_t sample(std::uint64_t seed) {
+    std::mt19937 gen{static_cast<std::uint32_t>(seed)};
+    std::set<std::uint32_t> values;
+    for (auto i = 0; i < 2000; ++i) {
+        values.insert(static_cast<std::uint32_t>(gen()));
+    }
+    for (auto i = 0; i < 6000; ++i) {
+        values.insert(0x0003'0000 + gen() % 0x10000);
+    }
+    for (std::uint32_t i = 0; i < 70'000; ++i) {
+        values.insert(0x0007'f000 + static_cast<std::uint32_t>(seed) + i);
+    }
+    return values_t(values.begin(), values.end());
+}
+
+static jtl::compressed_bitmap bitmap_of(const values_t &values) {
+    jtl::compressed_bitmap bitmap;
+    for (const auto value : values) {
+        bitmap.add(value);
+    }
+    return bitmap;
+}
+
+TEST(CompressedBitmapTest, AddContainsRemove) {
+    const auto values = sample(1);
+    auto bitmap = bitmap_of(values);
+    EXPECT_EQ(bitmap.cardinality(), values.size());
+    EXPECT_EQ(values_of(bitmap), values);
+    EXPECT_TRUE(bitmap.contains(values[10]) && !bitmap.contains(0x0002'0000));
+    for (std::size_t i = 0; i < values.size(); i += 2) {
+        bitmap.remove(values[i]);
+    }
+    values_t odd;
+    for (std::size_t i = 1; i < values.size(); i += 2) {
+        odd.push_back(values[i]);
+    }
+    EXPECT_EQ(values_of(bitmap), odd);
+    for (const auto value : odd) {
+        bitmap.remove(value);
+    }
+    EXPECT_TRUE(bitmap.empty() && bitmap.begin() == bitmap.end());
+}
+
+TEST(CompressedBitmapTest, SetOperations) {
+    const auto a = sample(1);
+    const auto b = sample(2);
+    auto ba = bitmap_of(a);
+    auto bb = bitmap_of(b);
+    // Plain chunks, runs on one side, runs on both
+    for (auto optimized : {0, 1, 2}) {
+        if (optimized == 1) {
+            bb.run_optimize();
+        } else if (optimized == 2) {
+            ba.run_optimize();
+        }
+        values_t expected;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                std::back_inserter(expected));
+        EXPECT_EQ(values_of(ba & bb), expected);
+        expected.clear();
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                std::back_inserter(expected));
+        EXPECT_EQ(values_of(ba | bb), expected);
+        EXPECT_EQ((ba | bb).cardinality(), expected.size());
+        expected.clear();
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                std::back_inserter(expected));
+        EXPECT_EQ(values_of(ba - bb), expected);
+        expected.clear();
+        std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                std::back_inserter(expected));
+        EXPECT_EQ(values_of(ba ^ bb), expected);
+    }
+    auto c = ba;
+    c &= bb;
+    c |= ba;
+    EXPECT_EQ(c, ba);
+    c -= ba;
+    EXPECT_TRUE(c.empty());
+}
+
+TEST(CompressedBitmapTest, Ranges) {
+    jtl::compressed_bitmap bitmap;
+    bitmap.add_range(0xfff0, 0x30010);
+    bitmap.add(5);
+    bitmap.add(0x3'0020);
+    bitmap.remove(0x2'0000);
+    EXPECT_EQ(bitmap.cardinality(), 0x20020 - 1 + 2);
+    EXPECT_TRUE(bitmap.contains(0xfff0) && bitmap.contains(0x3000f) &&
+            !bitmap.contains(0x30010) && !bitmap.contains(0x2'0000));
+    bitmap.add_range(0xffff'fff0, std::uint64_t{1} << 33);
+    EXPECT_TRUE(bitmap.contains(0xffff'ffff));
+    // Whole chunks stored as runs take a few bytes
+    EXPECT_LT(bitmap.size_in_bytes(), 100);
+
+    values_t values;
+    bitmap.for_each([&](std::uint32_t value) { values.push_back(value); });
+    EXPECT_EQ(values, values_of(bitmap));
+}
+
+TEST(CompressedBitmapTest, RunOptimize) {
+    auto bitmap = bitmap_of(sample(3));
+    const auto before = bitmap.size_in_bytes();
+    const auto values = values_of(bitmap);
+    bitmap.run_optimize();
+    EXPECT_LT(bitmap.size_in_bytes(), before);
+    EXPECT_EQ(values_of(bitmap), values);
+    bitmap.add(0x0008'0000 + 2);
+    bitmap.remove(0x0008'0000 + 10);
+    EXPECT_TRUE(bitmap.contains(0x0008'0000 + 2) &&
+            !bitmap.contains(0x0008'0000 + 10) &&
+            bitmap.contains(0x0008'0000 + 11));
+}
+
+TEST(CompressedBitmapTest, RunOperationsStaySmall) {
+    // Clustered sets over 2^24 IDs, a run per chunk
+    jtl::compressed_bitmap a;
+    jtl::compressed_bitmap b;
+    a.add_range(0, std::uint64_t{1} << 24);
+    b.add_range(0x8000, (std::uint64_t{1} << 24) + 0x8000);
+    EXPECT_LT(a.size_in_bytes(), 2048);
+    EXPECT_LT(b.size_in_bytes(), 2048);
+
+    const auto both = a & b;
+    EXPECT_EQ(both.cardinality(), (std::size_t{1} << 24) - 0x8000);
+    EXPECT_LT(both.size_in_bytes(), 2048);
+    const auto only_a = a - b;
+    EXPECT_EQ(only_a.cardinality(), 0x8000);
+    EXPECT_LT(only_a.size_in_bytes(), 16);
+    const auto either = a ^ b;
+    EXPECT_EQ(either.cardinality(), 0x10000);
+    EXPECT_TRUE(either.contains(0x7fff) && !either.contains(0x8000) &&
+            either.contains((std::uint32_t{1} << 24) + 0x7fff));
+    EXPECT_LT(either.size_in_bytes(), 32);
+
+    // A bitmap chunk against a run list comes out in the smaller form
+    jtl::compressed_bitmap block;
+    for (std::uint32_t i = 0; i < 0x8000; ++i) {
+        block.add(i);
+    }
+    jtl::compressed_bitmap head;
+    head.add_range(0, 0x1000);
+    const auto tail = block - head;
+    EXPECT_EQ(tail.cardinality(), 0x7000);
+    EXPECT_LT(tail.size_in_bytes(), 16);
+    EXPECT_EQ((block | a).size_in_bytes(), a.size_in_bytes());
+}
+
+TEST(CompressedBitmapTest, InitializerList) {
+    const jtl::compressed_bitmap bitmap{7, 1u << 20, 3, 7};
+    EXPECT_EQ(values_of(bitmap), (values_t{3, 7, 1u << 20}));
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
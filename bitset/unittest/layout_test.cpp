@@ -0,0 +1,109 @@
+#include "layout.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+using ipv4 = jtl::layout<jtl::field<"ver", 4>, jtl::field<"ihl", 4>,
+        jtl::field<"tos", 8>, jtl::field<"len", 16>, jtl::field<"id", 16>,
+        jtl::field<"flags", 3>, jtl::field<"frag", 13>, jtl::field<"ttl", 8>,
+        jtl::field<"proto", 8>, jtl::field<"csum", 16>,
+        jtl::field<"src", 32>, jtl::field<"dst", 32>>;
+
+using ipv6 = jtl::layout<jtl::field<"ver", 4>, jtl::field<"tc", 8>,
+        jtl::field<"flow", 20>, jtl::field<"len", 16>, jtl::field<"next", 8>,
+        jtl::field<"hops", 8>, jtl::field<"src", 128>,
+        jtl::field<"dst", 128>>;
+
+template <typename... Bytes>
+static constexpr auto bytes(Bytes... values) {
+    return std::array{std::byte{static_cast<std::uint8_t>(values)}...};
+}
+
+static constexpr auto Ipv4_Packet = bytes(0x45, 0x00, 0x00, 0x54, 0x1c,
+        0x46, 0x40, 0x00, 0x40, 0x01, 0xb1, 0xe6, 0xc0, 0xa8, 0x00, 0x68,
+        0xc0, 0xa8, 0x00, 0x01);
+
+TEST(LayoutTest, Offsets) {
+    static_assert(ipv4::Size_Bits == 160 && ipv4::Size_Bytes == 20);
+    static_assert(ipv4::Offset<"ver"> == 0 && ipv4::Width<"ver"> == 4);
+    static_assert(ipv4::Offset<"frag"> == 51 && ipv4::Width<"frag"> == 13);
+    static_assert(ipv4::Offset<"dst"> == 128 && ipv4::Index<"dst"> == 11);
+    static_assert(ipv6::Size_Bytes == 40 && ipv6::Offset<"dst"> == 192);
+    EXPECT_TRUE(true);
+}
+
+TEST(LayoutTest, GetConstexpr) {
+    static_assert(jtl::to_uint64(ipv4::get<"ver">(Ipv4_Packet)) == 4);
+    static_assert(jtl::to_uint64(ipv4::get<"ihl">(Ipv4_Packet)) == 5);
+    static_assert(jtl::to_uint64(ipv4::get<"flags">(Ipv4_Packet)) == 2);
+    static_assert(jtl::to_uint64(ipv4::get<"frag">(Ipv4_Packet)) == 0);
+    static_assert(jtl::to_uint64(ipv4::get<"csum">(Ipv4_Packet)) == 0xb1e6);
+    static_assert(jtl::to_uint64(ipv4::get<"src">(Ipv4_Packet)) ==
+            0xc0a8'0068);
+    EXPECT_EQ(ipv4::get<"ttl">(Ipv4_Packet), std::bitset<8>{64});
+}
+
+TEST(LayoutTest, Set) {
+    auto packet = Ipv4_Packet;
+    ipv4::set<"ttl">(packet, 63);
+    ipv4::set<"frag">(packet, 0x1abc);
+    ipv4::set<"flags">(packet, 1);
+    EXPECT_EQ(ipv4::get<"ttl">(packet), std::bitset<8>{63});
+    EXPECT_EQ(ipv4::get<"frag">(packet), std::bitset<13>{0x1abc});
+    EXPECT_EQ(ipv4::get<"flags">(packet), std::bitset<3>{1});
+    // Neighbours are left alone
+    EXPECT_EQ(ipv4::get<"id">(packet), std::bitset<16>{0x1c46});
+    EXPECT_EQ(ipv4::get<"proto">(packet), std::bitset<8>{1});
+}
+
+TEST(LayoutTest, ParseDeparse) {
+    const auto fields = ipv4::parse(Ipv4_Packet);
+    EXPECT_EQ(std::get<3>(fields), std::bitset<16>{0x54});
+    EXPECT_EQ(std::get<11>(fields), std::bitset<32>{0xc0a8'0001});
+    std::array<std::byte, 32> buffer{};
+    ipv4::deparse(buffer, fields);
+    EXPECT_TRUE(std::equal(
+            Ipv4_Packet.begin(), Ipv4_Packet.end(), buffer.begin()));
+    EXPECT_EQ(ipv4::to_bitset(Ipv4_Packet),
+            std::apply([](const auto &...f) { return jtl::concat(f...); },
+                    fields));
+}
+
+TEST(LayoutTest, WideFields) {
+    std::array<std::byte, ipv6::Size_Bytes> packet{};
+    std::bitset<128> src{0x2001'0db8'0000'0000};
+    src <<= 64;
+    src |= std::bitset<128>{0x0000'0000'0000'0001};
+    ipv6::deparse(packet, 6, 0xa5, 0xbcdef, 1280, 58, 255, src, ~src);
+    EXPECT_EQ(packet[0], std::byte{0x6a});
+    EXPECT_EQ(packet[8], std::byte{0x20});
+    EXPECT_EQ(packet[23], std::byte{0x01});
+    EXPECT_EQ(ipv6::get<"src">(packet), src);
+    EXPECT_EQ(ipv6::get<"dst">(packet), ~src);
+    EXPECT_EQ(ipv6::get<"flow">(packet), std::bitset<20>{0xbcdef});
+
+    using odd = jtl::layout<jtl::field<"a", 3>, jtl::field<"b", 70>,
+            jtl::field<"c", 7>>;
+    std::array<std::byte, odd::Size_Bytes> buffer{};
+    std::bitset<70> b{0x0123'4567'89ab'cdef};
+    b[69] = b[64] = 1;
+    odd::deparse(buffer, 5, b, 0x55);
+    EXPECT_TRUE(odd::get<"a">(buffer) == 5 && odd::get<"b">(buffer) == b &&
+            odd::get<"c">(buffer) == 0x55);
+}
+
+TEST(LayoutTest, ShortBuffer) {
+    std::array<std::byte, 19> buffer{};
+    EXPECT_THROW(ipv4::parse(buffer), std::out_of_range);
+    EXPECT_THROW(ipv4::deparse(buffer, ipv4::value_type{}), std::out_of_range);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
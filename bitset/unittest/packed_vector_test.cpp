@@ -0,0 +1,122 @@
+#include "packed_vector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Pushes random values and reads them back one by one and in bulk
+template <std::size_t Bits>
+static void round_trip() {
+    std::mt19937_64 gen{Bits};
+    std::vector<std::uint64_t> values(1'000);
+    jtl::packed_vector<Bits> vec;
+    for (auto &value : values) {
+        value = gen() & jtl::packed_vector<Bits>::max_value();
+        vec.push_back(value);
+    }
+    ASSERT_EQ(vec.size(), values.size());
+    EXPECT_EQ(vec.size_in_bytes(), (values.size() * Bits + 63) / 64 * 8);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(vec[i], values[i]) << "Bits " << Bits << " index " << i;
+    }
+    std::vector<std::uint64_t> out(values.size() - 7);
+    vec.get(7, std::span{out});
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), values.begin() + 7));
+}
+
+TEST(PackedVectorTest, RoundTrip) {
+    round_trip<1>();
+    round_trip<5>();
+    round_trip<12>();
+    round_trip<32>();
+    round_trip<33>();
+    round_trip<63>();
+    round_trip<64>();
+}
+
+TEST(PackedVectorTest, ProxyReference) {
+    jtl::packed_vector<7> vec(20);
+    vec[9] = 100;
+    vec[10] = 200;  // truncated to 7 bits
+    vec[3] = vec[9];
+    ++vec[4];
+    vec[5] -= 1;
+    EXPECT_EQ(vec[9], 100u);
+    EXPECT_EQ(vec[10], 200u & 0x7f);
+    EXPECT_EQ(vec[3], 100u);
+    EXPECT_EQ(vec[4], 1u);
+    EXPECT_EQ(vec[5], 0x7fu);
+    EXPECT_EQ(vec[8], 0u);
+    EXPECT_EQ(vec[11], 0u);
+    swap(vec[3], vec[4]);
+    EXPECT_EQ(vec[3], 1u);
+    EXPECT_EQ(vec[4], 100u);
+    EXPECT_THROW(static_cast<void>(vec.at(20)), std::out_of_range);
+}
+
+TEST(PackedVectorTest, BulkSet) {
+    jtl::packed_vector<12> vec(100, 0xfff);
+    const std::vector<std::uint16_t> in{1, 2, 3, 4095, 4096, 6};
+    vec.set(45, std::span{in});
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        const std::uint64_t expected =
+                i >= 45 && i < 51 ? in[i - 45] & 0xfff : 0xfff;
+        ASSERT_EQ(vec[i], expected) << i;
+    }
+    std::vector<std::uint16_t> out(3);
+    EXPECT_THROW(vec.get(98, std::span{out}), std::out_of_range);
+    EXPECT_THROW(vec.set(98, std::span{in}), std::out_of_range);
+}
+
+TEST(PackedVectorTest, Resize) {
+    jtl::packed_vector<5> vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+    vec.resize(3);
+    vec.resize(20, 31);
+    EXPECT_EQ(vec.size(), 20u);
+    EXPECT_EQ(vec[2], 3u);
+    EXPECT_EQ(vec[3], 31u);
+    EXPECT_EQ(vec[19], 31u);
+    vec.pop_back();
+    vec.push_back(0);
+    EXPECT_EQ(vec.back(), 0u);
+    EXPECT_EQ(vec, (jtl::packed_vector<5>{1, 2, 3, 31, 31, 31, 31, 31, 31,
+                           31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 0}));
+    vec.clear();
+    EXPECT_TRUE(vec.empty());
+}
+
+TEST(PackedVectorTest, Iterators) {
+    jtl::packed_vector<9> vec(50);
+    std::iota(vec.begin(), vec.end(), 0);
+    EXPECT_EQ(std::accumulate(vec.cbegin(), vec.cend(), std::uint64_t{}),
+            50u * 49 / 2);
+    auto it = vec.begin() + 10;
+    EXPECT_EQ(*it, 10u);
+    EXPECT_EQ(it[5], 15u);
+    it += 20;
+    EXPECT_EQ(it - vec.begin(), 30);
+    EXPECT_TRUE(vec.begin() < it && it < vec.end());
+    EXPECT_EQ(*std::prev(vec.end()), 49u);
+    EXPECT_EQ(*vec.rbegin(), 49u);
+    const auto found = std::find(vec.cbegin(), vec.cend(), 42u);
+    EXPECT_EQ(found - vec.cbegin(), 42);
+    std::reverse(vec.begin(), vec.end());
+    EXPECT_EQ(vec.front(), 49u);
+    EXPECT_EQ(vec.back(), 0u);
+    const auto &cvec = vec;
+    jtl::packed_vector<9>::const_iterator cit = vec.begin();
+    EXPECT_EQ(cit, cvec.begin());
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
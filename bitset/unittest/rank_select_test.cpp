@@ -0,0 +1,89 @@
+#include "rank_select.hpp"
+
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Checks every rank and select against a plain scan
+static void check(const jtl::rank_select_bitvector &bv,
+        const std::vector<bool> &bits) {
+    ASSERT_EQ(bv.size(), bits.size());
+    std::size_t ones{};
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        ASSERT_EQ(bv.rank1(i), ones);
+        ASSERT_EQ(bv[i], bits[i]);
+        if (bits[i]) {
+            ASSERT_EQ(bv.select1(ones), i);
+            ++ones;
+        }
+    }
+    EXPECT_EQ(bv.rank1(bits.size()), ones);
+    EXPECT_EQ(bv.count(), ones);
+    EXPECT_THROW(static_cast<void>(bv.select1(ones)), std::out_of_range);
+}
+
+TEST(RankSelectTest, Densities) {
+    std::mt19937_64 gen{42};
+    for (const auto density : {0.0005, 0.02, 0.5, 0.97}) {
+        std::bernoulli_distribution dist{density};
+        std::vector<bool> bits(300'007);
+        std::vector<std::uint64_t> words((bits.size() + 63) / 64);
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            bits[i] = dist(gen);
+            words[i / 64] |= std::uint64_t{bits[i]} << (i % 64);
+        }
+        check(jtl::rank_select_bitvector{words, bits.size()}, bits);
+    }
+}
+
+TEST(RankSelectTest, Positions) {
+    // Runs of ones separated by gaps longer than a superblock
+    std::vector<std::uint64_t> positions;
+    std::vector<bool> bits(400'000);
+    for (std::size_t run = 0; run < 3; ++run) {
+        for (std::size_t i = 0; i < 20'000; ++i) {
+            positions.push_back(run * 150'000 + i);
+            bits[run * 150'000 + i] = true;
+        }
+    }
+    check(jtl::rank_select_bitvector{bits.size(), positions}, bits);
+    EXPECT_THROW(jtl::rank_select_bitvector(10, std::vector{10}),
+            std::out_of_range);
+}
+
+TEST(RankSelectTest, Bitset) {
+    std::bitset<130> bs{};
+    bs[0] = bs[64] = bs[129] = 1;
+    const jtl::rank_select_bitvector bv{bs};
+    EXPECT_TRUE(bv.count() == 3 && bv.rank1(65) == 2 && bv.rank0(65) == 63);
+    EXPECT_TRUE(bv.select1(0) == 0 && bv.select1(1) == 64 &&
+            bv.select1(2) == 129);
+    EXPECT_THROW(static_cast<void>(bv.test(130)), std::out_of_range);
+}
+
+TEST(RankSelectTest, TrailingBitsIgnored) {
+    const jtl::rank_select_bitvector bv{std::vector{~std::uint64_t{}}, 10};
+    EXPECT_EQ(bv.count(), 10);
+    EXPECT_THROW(jtl::rank_select_bitvector(std::vector<std::uint64_t>{}, 1),
+            std::invalid_argument);
+    const jtl::rank_select_bitvector empty{};
+    EXPECT_TRUE(empty.size() == 0 && empty.rank1(0) == 0);
+}
+
+TEST(RankSelectTest, SpaceOverhead) {
+    std::vector<std::uint64_t> words(1 << 20, 0x5555'5555'5555'5555);
+    const jtl::rank_select_bitvector bv{words, words.size() * 64};
+    const auto bits_bytes = words.size() * sizeof(std::uint64_t);
+    EXPECT_LT(bv.size_in_bytes(), bits_bytes + bits_bytes / 20);
+    EXPECT_EQ(bv.select1(bv.count() - 1), bv.size() - 2);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,121 @@
+#include "ternary_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// src ip, dst ip, protocol and destination port
+using flow_key = std::bitset<88>;
+using table_t = jtl::ternary_table<88, std::string>;
+
+static flow_key key(std::uint32_t src, std::uint32_t dst, std::uint8_t proto,
+        std::uint16_t port) {
+    return jtl::concat(std::bitset<32>{src}, std::bitset<32>{dst},
+            std::bitset<8>{proto}, std::bitset<16>{port});
+}
+
+static flow_key prefix_mask(unsigned src_len, unsigned dst_len, bool proto,
+        bool port) {
+    const auto prefix = [](unsigned len) {
+        return std::bitset<32>{len == 0 ? 0 : ~0u << (32 - len)};
+    };
+    return jtl::concat(prefix(src_len), prefix(dst_len),
+            std::bitset<8>{proto ? 0xffu : 0u},
+            std::bitset<16>{port ? 0xffffu : 0u});
+}
+
+TEST(TernaryTableTest, Priorities) {
+    table_t table;
+    EXPECT_TRUE(table.insert(key(0x0a000000, 0, 0, 0),
+            prefix_mask(8, 0, false, false), 10, "10/8"));
+    EXPECT_TRUE(table.insert(key(0x0a010000, 0, 6, 0),
+            prefix_mask(16, 0, true, false), 20, "10.1/16 tcp"));
+    EXPECT_TRUE(table.insert(key(0, 0, 0, 0), flow_key{}, 0, "default"));
+    EXPECT_TRUE(table.insert(key(0, 0xc0a80001, 6, 443),
+            prefix_mask(0, 32, true, true), 30, "https host"));
+    EXPECT_EQ(table.size(), 4);
+    EXPECT_EQ(table.tuple_count(), 4);
+
+    EXPECT_EQ(*table.lookup(key(0x0a010203, 1, 6, 80)), "10.1/16 tcp");
+    EXPECT_EQ(*table.lookup(key(0x0a010203, 1, 17, 80)), "10/8");
+    EXPECT_EQ(*table.lookup(key(0x0a010203, 0xc0a80001, 6, 443)),
+            "https host");
+    EXPECT_EQ(*table.lookup(key(0x0b000000, 2, 1, 0)), "default");
+
+    // Same value, mask and priority replaces the action
+    EXPECT_FALSE(table.insert(key(0x0a000000, 0, 0, 0),
+            prefix_mask(8, 0, false, false), 10, "ten"));
+    EXPECT_EQ(*table.lookup(key(0x0a010203, 1, 17, 80)), "ten");
+
+    EXPECT_TRUE(table.erase(key(0, 0, 0, 0), flow_key{}, 0));
+    EXPECT_FALSE(table.erase(key(0, 0, 0, 0), flow_key{}, 0));
+    EXPECT_EQ(table.lookup(key(0x0b000000, 2, 1, 0)), nullptr);
+    EXPECT_EQ(table.tuple_count(), 3);
+}
+
+// Random rules against a linear scan, one key at a time and in batches
+TEST(TernaryTableTest, MatchesLinearScan) {
+    struct rule {
+        flow_key value;
+        flow_key mask;
+        std::uint32_t priority;
+    };
+    std::mt19937 gen{5};
+    table_t table;
+    std::vector<rule> rules;
+    for (std::uint32_t i = 0; i < 2000; ++i) {
+        const auto mask = prefix_mask(gen() % 4 * 8, gen() % 3 * 16,
+                gen() % 2 == 0, gen() % 4 == 0);
+        const auto value = key(gen() & 0x0f0f0f0f, gen() & 0x0f0f0f0f,
+                                   static_cast<std::uint8_t>(gen() % 3),
+                                   static_cast<std::uint16_t>(gen() % 4)) &
+                mask;
+        rules.push_back({value, mask, i});
+        table.insert(value, mask, i, std::to_string(i));
+    }
+    // Drop a quarter of them again
+    for (std::size_t i = 0; i < rules.size(); i += 4) {
+        EXPECT_TRUE(table.erase(rules[i].value, rules[i].mask,
+                rules[i].priority));
+        rules[i].priority = ~0u;
+    }
+
+    std::vector<flow_key> keys;
+    for (auto i = 0; i < 512; ++i) {
+        keys.push_back(key(gen() & 0x0f0f0f0f, gen() & 0x0f0f0f0f,
+                static_cast<std::uint8_t>(gen() % 3),
+                static_cast<std::uint16_t>(gen() % 4)));
+    }
+    std::vector<const std::string *> batch(keys.size());
+    for (std::size_t first = 0; first < keys.size(); first += 64) {
+        table.lookup(std::span{keys}.subspan(first, 64),
+                std::span{batch}.subspan(first, 64));
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const rule *best{};
+        for (const auto &r : rules) {
+            if (r.priority != ~0u && (keys[i] & r.mask) == r.value &&
+                    (best == nullptr || r.priority > best->priority)) {
+                best = &r;
+            }
+        }
+        const auto *found = table.lookup(keys[i]);
+        ASSERT_EQ(found == nullptr, best == nullptr);
+        ASSERT_EQ(batch[i], found);
+        if (best != nullptr) {
+            ASSERT_EQ(*found, std::to_string(best->priority));
+        }
+    }
+    std::vector<const std::string *> short_batch(1);
+    EXPECT_THROW(table.lookup(std::span{keys}, std::span{short_batch}),
+            std::length_error);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
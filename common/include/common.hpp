@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 
 namespace jtl {
 
+// Padding unit that keeps data written by different threads apart
+inline constexpr std::size_t Cache_Line_Bytes = 64;
+
 // Concepts
 template <typename To, typename... From>
 concept Is_Same_Decay = (std::is_same_v<std::decay_t<From>, To> && ...);
@@ -93,4 +93,22 @@ constexpr auto operator-(const RandomAccessIterator<T> &lhs,
     return lhs.operator->() - rhs.operator->();
 }
 
+template <typename T>
+constexpr auto operator+(
+        const RandomAccessIterator<T> &it, std::ptrdiff_t offset) {
+    return RandomAccessIterator<T>(it.operator->() + offset);
+}
+
+template <typename T>
+constexpr auto operator+(
+        std::ptrdiff_t offset, const RandomAccessIterator<T> &it) {
+    return it + offset;
+}
+
+template <typename T>
+constexpr auto operator-(
+        const RandomAccessIterator<T> &it, std::ptrdiff_t offset) {
+    return RandomAccessIterator<T>(it.operator->() - offset);
+}
+
 }  // namespace jtl
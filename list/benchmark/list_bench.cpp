@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "intrusive_list.hpp"
+#include "list.hpp"
+#include "mpsc_queue.hpp"
+#include "pool_allocator.hpp"
+#include "unrolled_list.hpp"
+
+// Queue like churn: the list keeps a steady depth while nodes come and go
+template <typename List>
+static void BM_Churn(benchmark::State &state) {
+    const auto depth = state.range(0);
+    List l;
+    for (auto _ : state) {
+        for (auto i = 0; i < depth; ++i) {
+            l.push_back(static_cast<std::uint64_t>(i));
+        }
+        for (auto i = 0; i < depth; ++i) {
+            l.pop_back();
+        }
+    }
+    state.SetItemsProcessed(2 * depth * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Churn, jtl::list<std::uint64_t>)->Range(1 << 4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_Churn,
+        jtl::list<std::uint64_t, jtl::pool_allocator<std::uint64_t>>)
+        ->Range(1 << 4, 1 << 12);
+
+// Full traversal after interleaved churn, nodes from the pool stay packed
+template <typename List>
+static void BM_Traverse(benchmark::State &state) {
+    List l;
+    for (auto i = 0; i < state.range(0); ++i) {
+        l.push_back(static_cast<std::uint64_t>(i));
+    }
+    for (auto _ : state) {
+        std::uint64_t sum{};
+        for (const auto &el : l) {
+            sum += el;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Traverse, jtl::list<std::uint64_t>)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Traverse,
+        jtl::list<std::uint64_t, jtl::pool_allocator<std::uint64_t>>)
+        ->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Traverse, jtl::unrolled_list<std::uint64_t>)
+        ->Range(1 << 10, 1 << 16);
+
+// Objects that already live elsewhere, linked in and out of a list
+struct connection {
+    std::uint64_t id;
+    jtl::list_hook<connection> hook;
+};
+
+template <bool Intrusive>
+static void BM_LinkExisting(benchmark::State &state) {
+    std::vector<connection> conns(static_cast<std::size_t>(state.range(0)));
+    jtl::intrusive_list<connection, &connection::hook> linked;
+    jtl::list<connection> copied;
+    for (auto _ : state) {
+        for (auto &conn : conns) {
+            if constexpr (Intrusive) {
+                linked.push_back(conn);
+            } else {
+                copied.push_back(conn);
+            }
+        }
+        if constexpr (Intrusive) {
+            linked.clear();
+        } else {
+            copied.clear();
+        }
+    }
+    state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_LinkExisting, false)->Range(1 << 4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_LinkExisting, true)->Range(1 << 4, 1 << 12);
+
+// Producers feeding one consumer through a mutex guarded jtl::list and
+// through jtl::mpsc_queue
+template <bool Lock_Free>
+static void BM_FanIn(benchmark::State &state) {
+    const auto producers = static_cast<int>(state.range(0));
+    constexpr std::uint64_t Per_Producer = 1 << 16;
+    const auto total = Per_Producer * static_cast<std::uint64_t>(producers);
+    jtl::mpsc_queue<std::uint64_t> queue;
+    jtl::list<std::uint64_t> list;
+    std::mutex mutex;
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (auto p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                for (std::uint64_t i = 0; i < Per_Producer; ++i) {
+                    if constexpr (Lock_Free) {
+                        queue.push(i);
+                    } else {
+                        std::lock_guard lock{mutex};
+                        list.push_front(i);
+                    }
+                }
+            });
+        }
+        std::uint64_t received{};
+        std::uint64_t sum{};
+        while (received < total) {
+            if constexpr (Lock_Free) {
+                received += queue.drain([&](std::uint64_t v) { sum += v; });
+            } else {
+                std::lock_guard lock{mutex};
+                for (; !list.empty(); ++received) {
+                    sum += list.back();
+                    list.pop_back();
+                }
+            }
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(
+            static_cast<std::int64_t>(total) * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_FanIn, false)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FanIn, true)->Arg(1)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
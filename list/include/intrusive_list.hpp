@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Doubly linked list of objects owned elsewhere
+ *  Objects embed a jtl::list_hook per list they may be in, the list only
+ *  links them through it: nothing is allocated, copied or destroyed.
+ *  Objects must stay alive and in place while linked and may sit in one
+ *  list per hook. Like jtl::list, the ends are null, so moving a list
+ *  only moves its head, tail and size
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace jtl {
+
+template <typename T>
+struct list_hook {
+    T *next = nullptr;
+    T *previous = nullptr;
+};
+
+template <typename T, list_hook<T> T::*Hook>
+class intrusive_list {
+ private:
+    static list_hook<T> &hook(T &obj) noexcept {
+        return obj.*Hook;
+    }
+
+    template <typename V>
+    class intrusive_iterator {
+        friend class intrusive_list;
+
+        T *data_{nullptr};
+        // end() is null, decrementing it needs the tail
+        const intrusive_list *list_{nullptr};
+
+        constexpr intrusive_iterator(T *ptr, const intrusive_list *list)
+                : data_{ptr}, list_{list} {}
+
+     public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V *;
+        using reference = V &;
+
+        constexpr intrusive_iterator() = default;
+
+        // iterator to const_iterator
+        template <typename U>
+            requires std::is_convertible_v<U *, V *>
+        constexpr intrusive_iterator(const intrusive_iterator<U> &it)
+                : data_{it.data_}, list_{it.list_} {}
+
+        constexpr intrusive_iterator &operator++() {
+            data_ = hook(*data_).next;
+            return *this;
+        }
+        constexpr intrusive_iterator operator++(int) {
+            auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        constexpr intrusive_iterator &operator--() {
+            data_ = data_ == nullptr ? list_->tail_ : hook(*data_).previous;
+            return *this;
+        }
+        constexpr intrusive_iterator operator--(int) {
+            auto ret = *this;
+            --*this;
+            return ret;
+        }
+
+        constexpr reference operator*() const {
+            return *data_;
+        }
+        constexpr pointer operator->() const {
+            return data_;
+        }
+
+        constexpr bool operator==(const intrusive_iterator &other) const {
+            return data_ == other.data_;
+        }
+
+        template <typename U>
+        friend class intrusive_iterator;
+    };
+
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = intrusive_iterator<T>;
+    using const_iterator = intrusive_iterator<const T>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    intrusive_list() = default;
+
+    intrusive_list(const intrusive_list &) = delete;
+    intrusive_list &operator=(const intrusive_list &) = delete;
+
+    intrusive_list(intrusive_list &&other) noexcept
+            : head_{other.head_}, tail_{other.tail_}, size_{other.size_} {
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    intrusive_list &operator=(intrusive_list &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head_ = other.head_;
+            tail_ = other.tail_;
+            size_ = other.size_;
+            other.head_ = other.tail_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    // Unlinks the objects, which stay alive
+    ~intrusive_list() {
+        clear();
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T &front() {
+        return *head_;
+    }
+    const T &front() const {
+        return *head_;
+    }
+    T &back() {
+        return *tail_;
+    }
+    const T &back() const {
+        return *tail_;
+    }
+
+    void push_front(T &obj) noexcept {
+        insert(begin(), obj);
+    }
+
+    void push_back(T &obj) noexcept {
+        insert(end(), obj);
+    }
+
+    void pop_front() noexcept {
+        erase(*head_);
+    }
+
+    void pop_back() noexcept {
+        erase(*tail_);
+    }
+
+    // Links obj before pos, obj must not be in a list through Hook
+    iterator insert(const_iterator pos, T &obj) noexcept {
+        auto *next = pos.data_;
+        auto *previous = next == nullptr ? tail_ : hook(*next).previous;
+        hook(obj).next = next;
+        hook(obj).previous = previous;
+        (previous == nullptr ? head_ : hook(*previous).next) = &obj;
+        (next == nullptr ? tail_ : hook(*next).previous) = &obj;
+        ++size_;
+        return iterator(&obj, this);
+    }
+
+    // Unlinks obj, which must be in this list, in O(1). Returns the
+    // iterator to the object that followed it
+    iterator erase(T &obj) noexcept {
+        auto &h = hook(obj);
+        auto *next = h.next;
+        (h.previous == nullptr ? head_ : hook(*h.previous).next) = next;
+        (next == nullptr ? tail_ : hook(*next).previous) = h.previous;
+        h.next = h.previous = nullptr;
+        --size_;
+        return iterator(next, this);
+    }
+
+    iterator erase(const_iterator pos) noexcept {
+        return erase(*const_cast<T *>(pos.data_));
+    }
+
+    // Unlinks every object, leaving their hooks cleared
+    void clear() noexcept {
+        while (head_ != nullptr) {
+            auto &h = hook(*head_);
+            head_ = h.next;
+            h.next = h.previous = nullptr;
+        }
+        tail_ = nullptr;
+        size_ = 0;
+    }
+
+    // Iterator to obj, which must be in this list, in O(1)
+    iterator iterator_to(T &obj) noexcept {
+        return iterator(&obj, this);
+    }
+    const_iterator iterator_to(const T &obj) const noexcept {
+        return const_iterator(const_cast<T *>(&obj), this);
+    }
+
+    iterator begin() noexcept {
+        return iterator(head_, this);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(head_, this);
+    }
+    iterator end() noexcept {
+        return iterator(nullptr, this);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(nullptr, this);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+ private:
+    T *head_ = nullptr;
+    T *tail_ = nullptr;
+    size_type size_{0};
+};
+
+}  // namespace jtl
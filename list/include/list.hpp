@@ -14,12 +14,26 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
+/** @brief STL like doubly linked list
+ *  Nodes are obtained from Alloc rebound to the node type, so node pools
+ *  such as jtl::pool_allocator can serve them. splice, merge and sort
+ *  relink the existing nodes, they never allocate nor copy T. Nodes only
+ *  move between lists whose allocators compare equal, splice and merge
+ *  throw std::invalid_argument otherwise
+ */
+
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <stdexcept>
 
 namespace jtl {
 
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 class list {
  private:
     struct Node {
@@ -73,6 +87,8 @@ class list {
         constexpr auto operator<=>(const list_iterator &other) const = default;
 
      protected:
+        friend class list;
+
         pointer data_{nullptr};
     };
 
@@ -94,6 +110,7 @@ class list {
 
  public:
     using value_type = T;
+    using allocator_type = Alloc;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
     using reference = value_type &;
@@ -106,10 +123,15 @@ class list {
     using const_reverse_iterator = const list_reverse_iterator;
 
     list() = default;
+    explicit list(const allocator_type &alloc) : node_alloc_{alloc} {}
     ~list() {
         clear();
     }
 
+    [[nodiscard]] allocator_type get_allocator() const {
+        return allocator_type(node_alloc_);
+    }
+
     auto size() {
         return size_;
     }
@@ -131,34 +153,138 @@ class list {
     }
 
     void push_back(const T &value) {
-        auto node = new Node{value};
+        attach(nullptr, create_node(value));
+    }
+
+    void pop_back() {
         if (empty()) {
-            head_ = tail_ = node;
-            head_->next = tail_;
-        } else {
-            auto old_tail = tail_;
-            tail_ = node;
-            tail_->previous = old_tail;
-            old_tail->next = tail_;
+            return;
         }
-        ++size_;
+        auto old_tail = tail_;
+        detach(old_tail);
+        destroy_node(old_tail);
     }
 
-    void pop_back() {
+    void push_front(const T &value) {
+        attach(head_, create_node(value));
+    }
+
+    void pop_front() {
         if (empty()) {
             return;
-        } else {
-            auto old_tail = tail_;
-            if (tail_ != head_) {
-                tail_ = old_tail->previous;
-                tail_->next = nullptr;
-            } else {
-                tail_ = nullptr;
-                head_ = nullptr;
+        }
+        auto old_head = head_;
+        detach(old_head);
+        destroy_node(old_head);
+    }
+
+    // Inserts value before pos
+    iterator insert(iterator pos, const T &value) {
+        auto node = create_node(value);
+        attach(pos.data_, node);
+        return iterator(node);
+    }
+
+    // Removes the element at pos, returns the iterator to the next one
+    iterator erase(iterator pos) {
+        auto node = pos.data_;
+        auto next = node->next;
+        detach(node);
+        destroy_node(node);
+        return iterator(next);
+    }
+
+    // Moves every node of other before pos
+    void splice(iterator pos, list &other) {
+        if (&other == this || other.empty()) {
+            return;
+        }
+        splice(pos, other, other.begin(), other.end());
+    }
+
+    // Moves the node at it, from other or this list, before pos
+    void splice(iterator pos, list &other, iterator it) {
+        check_allocator(other);
+        auto node = it.data_;
+        if (&other == this && (node == pos.data_ || node->next == pos.data_)) {
+            return;
+        }
+        other.detach(node);
+        attach(pos.data_, node);
+    }
+
+    // Moves the nodes of [first, last) before pos, which must not be in
+    // the range. Relinking is O(1), nodes coming from another list are
+    // counted to keep both sizes
+    void splice(iterator pos, list &other, iterator first, iterator last) {
+        if (first == last) {
+            return;
+        }
+        check_allocator(other);
+        auto front = first.data_;
+        auto back = last.data_ == nullptr ? other.tail_ : last.data_->previous;
+        size_type count{};
+        if (&other != this) {
+            for (auto node = front; node != last.data_; node = node->next) {
+                ++count;
+            }
+        }
+        other.detach(front, back, count);
+        attach(pos.data_, front, back, count);
+    }
+
+    // Merges the sorted other into this sorted list in linear time,
+    // elements of this list first among equal ones
+    template <typename Compare = std::less<>>
+    void merge(list &other, Compare comp = Compare{}) {
+        if (&other == this) {
+            return;
+        }
+        check_allocator(other);
+        auto node = head_;
+        while (!other.empty()) {
+            auto moved = other.head_;
+            while (node != nullptr && !comp(moved->data, node->data)) {
+                node = node->next;
+            }
+            other.detach(moved);
+            attach(node, moved);
+        }
+    }
+
+    // Stable bottom-up merge sort: runs of 2^i nodes wait in bins[i]
+    // until a run of the same length comes to be merged with them
+    template <typename Compare = std::less<>>
+    void sort(Compare comp = Compare{}) {
+        if (size_ < 2) {
+            return;
+        }
+        Node *bins[64]{};
+        for (auto node = head_; node != nullptr;) {
+            auto run = node;
+            node = node->next;
+            run->next = nullptr;
+            std::size_t i = 0;
+            for (; bins[i] != nullptr; ++i) {
+                run = merge_runs(bins[i], run, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+        }
+        Node *sorted = nullptr;
+        for (auto bin : bins) {
+            if (bin != nullptr) {
+                sorted = sorted == nullptr ? bin
+                                           : merge_runs(bin, sorted, comp);
             }
-            delete old_tail;
-            --size_;
         }
+        head_ = sorted;
+        Node *previous = nullptr;
+        for (auto node = head_; node != nullptr; node = node->next) {
+            node->previous = previous;
+            previous = node;
+        }
+        tail_ = previous;
     }
 
     void clear() {
@@ -226,9 +352,89 @@ class list {
     }
 
  private:
+    using node_allocator_type = typename std::allocator_traits<
+            allocator_type>::template rebind_alloc<Node>;
+    using node_traits = std::allocator_traits<node_allocator_type>;
+
     Node *head_ = nullptr;
     Node *tail_ = nullptr;
     std::uint64_t size_{0};
+    node_allocator_type node_alloc_{};
+
+    Node *create_node(const T &value) {
+        auto node = std::to_address(node_traits::allocate(node_alloc_, 1));
+        try {
+            node_traits::construct(node_alloc_, node, value);
+        } catch (...) {
+            node_traits::deallocate(node_alloc_, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    // A node taken from other is later freed through this list's
+    // allocator, which must be able to free it
+    void check_allocator(const list &other) const {
+        if constexpr (!node_traits::is_always_equal::value) {
+            if (&other != this && node_alloc_ != other.node_alloc_) {
+                throw std::invalid_argument(
+                        "list: nodes can't move between unequal allocators");
+            }
+        }
+    }
+
+    void destroy_node(Node *node) {
+        node_traits::destroy(node_alloc_, node);
+        node_traits::deallocate(node_alloc_, node, 1);
+    }
+
+    // Links the chain front..back of count nodes before pos, at the end
+    // when pos is null
+    void attach(Node *pos, Node *front, Node *back, size_type count) {
+        auto previous = pos == nullptr ? tail_ : pos->previous;
+        front->previous = previous;
+        back->next = pos;
+        (previous == nullptr ? head_ : previous->next) = front;
+        (pos == nullptr ? tail_ : pos->previous) = back;
+        size_ += count;
+    }
+
+    void attach(Node *pos, Node *node) {
+        attach(pos, node, node, 1);
+    }
+
+    // Unlinks the chain front..back of count nodes
+    void detach(Node *front, Node *back, size_type count) {
+        (front->previous == nullptr ? head_ : front->previous->next) =
+                back->next;
+        (back->next == nullptr ? tail_ : back->next->previous) =
+                front->previous;
+        size_ -= count;
+    }
+
+    void detach(Node *node) {
+        detach(node, node, 1);
+    }
+
+    // Merges two null terminated sorted runs chained through next, a
+    // holds the earlier elements and wins ties
+    template <typename Compare>
+    static Node *merge_runs(Node *a, Node *b, Compare &comp) {
+        Node *head = nullptr;
+        auto link = &head;
+        while (a != nullptr && b != nullptr) {
+            if (comp(b->data, a->data)) {
+                *link = b;
+                b = b->next;
+            } else {
+                *link = a;
+                a = a->next;
+            }
+            link = &(*link)->next;
+        }
+        *link = a != nullptr ? a : b;
+        return head;
+    }
 };
 
 }  // namespace jtl
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Unbounded lock-free queue for many producers and one consumer
+ *  Dmitry Vyukov's design over singly linked nodes: a producer links its
+ *  node with one atomic exchange of the head and one store, the consumer
+ *  follows next pointers from a stub node with plain loads. An element
+ *  becomes visible once the producer that exchanged the head before it
+ *  has stored its link, so try_pop may briefly see an empty queue while
+ *  a producer is between the two steps.
+ *  Consumed nodes are recycled through a free stack the producers take
+ *  from before going to Alloc, so a warm queue doesn't allocate. The
+ *  consumer hands them back in batches, one compare and swap each.
+ *  Alloc must be safe to call from the producer threads; try_push only
+ *  uses recycled nodes, never Alloc. Node addresses must fit in 48
+ *  bits, allocating one above that throws std::bad_alloc
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "common.hpp"
+
+namespace jtl {
+
+template <typename T, typename Alloc = std::allocator<T>>
+class mpsc_queue {
+ private:
+    struct Node {
+        std::atomic<Node *> next = nullptr;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *data() noexcept {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    using node_allocator_type = typename std::allocator_traits<
+            Alloc>::template rebind_alloc<Node>;
+    using node_traits = std::allocator_traits<node_allocator_type>;
+
+    static_assert(sizeof(std::uintptr_t) == 8,
+            "mpsc_queue: the free stack tags 64-bit pointers");
+
+    // The free stack top keeps the node address in the low 48 bits and
+    // counts its updates in the high 16, so a producer holding a stale
+    // top fails its compare and swap (ABA). Addresses that don't fit,
+    // 5-level paging or tagged pointers (TBI, PAC, MTE), are refused
+    // when the node is allocated
+    static constexpr unsigned Tag_Shift = 48;
+    static constexpr std::uintptr_t Address_Mask =
+            (std::uintptr_t{1} << Tag_Shift) - 1;
+
+    // Nodes the consumer gathers before handing them back
+    static constexpr std::size_t Recycle_Batch = 32;
+
+ public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    mpsc_queue() : mpsc_queue(allocator_type{}) {}
+
+    explicit mpsc_queue(const allocator_type &alloc) : node_alloc_{alloc} {
+        auto stub = create_node();
+        head_.store(stub, std::memory_order_relaxed);
+        tail_ = stub;
+    }
+
+    mpsc_queue(const mpsc_queue &) = delete;
+    mpsc_queue &operator=(const mpsc_queue &) = delete;
+
+    // No producer nor consumer may be running
+    ~mpsc_queue() {
+        for (auto node = tail_->next.load(std::memory_order_acquire);
+                node != nullptr;) {
+            auto next = node->next.load(std::memory_order_relaxed);
+            std::destroy_at(node->data());
+            destroy_node(node);
+            node = next;
+        }
+        destroy_node(tail_);
+        destroy_chain(recycled_);
+        destroy_chain(address(free_.load(std::memory_order_acquire)));
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const {
+        return allocator_type(node_alloc_);
+    }
+
+    // Producers: recycled node or a new one from Alloc
+    template <typename... Args>
+    void emplace(Args &&...args) {
+        auto node = take_free();
+        if (node == nullptr) {
+            node = create_node();
+        }
+        link(node, std::forward<Args>(args)...);
+    }
+
+    void push(const T &value) {
+        emplace(value);
+    }
+    void push(T &&value) {
+        emplace(std::move(value));
+    }
+
+    // Producers: false when no recycled node is left, see reserve
+    template <typename... Args>
+    bool try_emplace(Args &&...args) {
+        auto node = take_free();
+        if (node == nullptr) {
+            return false;
+        }
+        link(node, std::forward<Args>(args)...);
+        return true;
+    }
+
+    bool try_push(const T &value) {
+        return try_emplace(value);
+    }
+    bool try_push(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    // Any thread: adds count nodes to the free stack
+    void reserve(size_type count) {
+        for (; count > 0; --count) {
+            auto node = create_node();
+            push_free(node, node);
+        }
+    }
+
+    // Consumer: moves the oldest element into value
+    bool try_pop(T &value) {
+        auto next = tail_->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(*next->data());
+        advance(next);
+        return true;
+    }
+
+    // Consumer: hands up to max elements, oldest first, to f(T &&) and
+    // returns how many. Nodes consumed are handed back right away
+    template <typename F>
+    size_type drain(F f,
+            size_type max = std::numeric_limits<size_type>::max()) {
+        size_type count{};
+        for (; count < max; ++count) {
+            auto next = tail_->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                break;
+            }
+            f(std::move(*next->data()));
+            advance(next);
+        }
+        if (recycled_ != nullptr) {
+            release_recycled();
+        }
+        return count;
+    }
+
+    // Consumer: nothing visible to pop
+    [[nodiscard]] bool empty() const noexcept {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+ private:
+    // Written by the producers
+    alignas(Cache_Line_Bytes) std::atomic<Node *> head_;
+    // Owned by the consumer
+    alignas(Cache_Line_Bytes) Node *tail_;
+    Node *recycled_ = nullptr;
+    Node *recycled_last_ = nullptr;
+    std::size_t recycled_count_{};
+    // Shared by everyone
+    alignas(Cache_Line_Bytes) std::atomic<std::uintptr_t> free_{0};
+    node_allocator_type node_alloc_;
+
+    static std::uintptr_t pack(Node *node, const std::uintptr_t top) {
+        return reinterpret_cast<std::uintptr_t>(node) |
+                (((top >> Tag_Shift) + 1) << Tag_Shift);
+    }
+
+    static Node *address(const std::uintptr_t top) {
+        return reinterpret_cast<Node *>(top & Address_Mask);
+    }
+
+    Node *create_node() {
+        auto node = std::to_address(node_traits::allocate(node_alloc_, 1));
+        if ((reinterpret_cast<std::uintptr_t>(node) & ~Address_Mask) != 0) {
+            node_traits::deallocate(node_alloc_, node, 1);
+            throw std::bad_alloc();
+        }
+        return ::new (static_cast<void *>(node)) Node;
+    }
+
+    void destroy_node(Node *node) noexcept {
+        node->~Node();
+        node_traits::deallocate(node_alloc_, node, 1);
+    }
+
+    void destroy_chain(Node *node) noexcept {
+        while (node != nullptr) {
+            auto next = node->next.load(std::memory_order_relaxed);
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    template <typename... Args>
+    void link(Node *node, Args &&...args) {
+        try {
+            std::construct_at(node->data(), std::forward<Args>(args)...);
+        } catch (...) {
+            push_free(node, node);
+            throw;
+        }
+        node->next.store(nullptr, std::memory_order_relaxed);
+        auto previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // next becomes the stub, the old one is recycled
+    void advance(Node *next) {
+        std::destroy_at(next->data());
+        auto node = std::exchange(tail_, next);
+        node->next.store(recycled_, std::memory_order_relaxed);
+        if (recycled_ == nullptr) {
+            recycled_last_ = node;
+        }
+        recycled_ = node;
+        if (++recycled_count_ == Recycle_Batch) {
+            release_recycled();
+        }
+    }
+
+    void release_recycled() noexcept {
+        push_free(recycled_, recycled_last_);
+        recycled_ = recycled_last_ = nullptr;
+        recycled_count_ = 0;
+    }
+
+    // Pushes the chain first..last, linked through next
+    void push_free(Node *first, Node *last) noexcept {
+        auto top = free_.load(std::memory_order_relaxed);
+        do {
+            last->next.store(address(top), std::memory_order_relaxed);
+        } while (!free_.compare_exchange_weak(top, pack(first, top),
+                std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Node *take_free() noexcept {
+        auto top = free_.load(std::memory_order_acquire);
+        while (address(top) != nullptr) {
+            auto node = address(top);
+            auto next = node->next.load(std::memory_order_relaxed);
+            if (free_.compare_exchange_weak(top, pack(next, top),
+                        std::memory_order_acquire,
+                        std::memory_order_acquire)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+};
+
+}  // namespace jtl
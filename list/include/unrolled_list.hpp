@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Doubly linked list of chunks holding several elements each
+ *  A chunk takes about ChunkBytes, a multiple of the cache line, and
+ *  keeps its elements contiguous in [first, last) of its slots, so a
+ *  traversal misses once per chunk instead of once per element.
+ *  push/pop at either end are O(1): a new chunk is started when the end
+ *  one is full and freed once emptied. Inserting in the middle of a full
+ *  chunk splits it in two halves, and a chunk left under half full by an
+ *  erasure is merged with a neighbour that has room for its elements, so
+ *  chunks don't decay to a handful of elements each. Insertions and
+ *  erasures invalidate the iterators into the chunks they touch, and into
+ *  the neighbour of a merged chunk. Chunks are obtained from Alloc rebound
+ *  to the chunk type, as jtl::list does with its nodes
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "common.hpp"
+
+namespace jtl {
+
+template <typename T, std::size_t ChunkBytes = 4 * Cache_Line_Bytes,
+        typename Alloc = std::allocator<T>>
+class unrolled_list {
+    static_assert(ChunkBytes % Cache_Line_Bytes == 0,
+            "unrolled_list: chunks are a multiple of the cache line");
+
+    static constexpr std::size_t Header_Bytes =
+            2 * sizeof(void *) + 2 * sizeof(std::uint32_t);
+
+ public:
+    // Elements per chunk, at least one
+    static constexpr std::size_t Chunk_Capacity = ChunkBytes > Header_Bytes
+            ? std::max<std::size_t>(1, (ChunkBytes - Header_Bytes) / sizeof(T))
+            : 1;
+
+ private:
+    // Starts on a cache line, so a chunk spans ChunkBytes / 64 of them
+    struct alignas(std::max(Cache_Line_Bytes, alignof(T))) chunk {
+        chunk *next = nullptr;
+        chunk *previous = nullptr;
+        std::uint32_t first{};
+        std::uint32_t last{};
+        alignas(T) std::byte storage[Chunk_Capacity * sizeof(T)];
+
+        T *slot(const std::size_t i) noexcept {
+            return std::launder(reinterpret_cast<T *>(storage) + i);
+        }
+        std::size_t size() const noexcept {
+            return last - first;
+        }
+    };
+
+    template <typename V>
+    class unrolled_iterator {
+        friend class unrolled_list;
+
+        chunk *chunk_{nullptr};
+        std::size_t index_{};
+        // end() has no chunk, decrementing it needs the tail
+        const unrolled_list *list_{nullptr};
+
+        constexpr unrolled_iterator(
+                chunk *c, const std::size_t index, const unrolled_list *list)
+                : chunk_{c}, index_{index}, list_{list} {}
+
+     public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V *;
+        using reference = V &;
+
+        constexpr unrolled_iterator() = default;
+
+        // iterator to const_iterator
+        template <typename U>
+            requires std::is_convertible_v<U *, V *>
+        constexpr unrolled_iterator(const unrolled_iterator<U> &it)
+                : chunk_{it.chunk_}, index_{it.index_}, list_{it.list_} {}
+
+        constexpr unrolled_iterator &operator++() {
+            if (++index_ == chunk_->last) {
+                chunk_ = chunk_->next;
+                index_ = chunk_ == nullptr ? 0 : chunk_->first;
+            }
+            return *this;
+        }
+        constexpr unrolled_iterator operator++(int) {
+            auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        constexpr unrolled_iterator &operator--() {
+            if (chunk_ == nullptr || index_ == chunk_->first) {
+                chunk_ = chunk_ == nullptr ? list_->tail_ : chunk_->previous;
+                index_ = chunk_->last;
+            }
+            --index_;
+            return *this;
+        }
+        constexpr unrolled_iterator operator--(int) {
+            auto ret = *this;
+            --*this;
+            return ret;
+        }
+
+        constexpr reference operator*() const {
+            return *chunk_->slot(index_);
+        }
+        constexpr pointer operator->() const {
+            return chunk_->slot(index_);
+        }
+
+        constexpr bool operator==(const unrolled_iterator &other) const {
+            return chunk_ == other.chunk_ && index_ == other.index_;
+        }
+
+        template <typename U>
+        friend class unrolled_iterator;
+    };
+
+ public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = unrolled_iterator<T>;
+    using const_iterator = unrolled_iterator<const T>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    unrolled_list() = default;
+    explicit unrolled_list(const allocator_type &alloc) : chunk_alloc_{alloc} {}
+
+    unrolled_list(std::initializer_list<T> init,
+            const allocator_type &alloc = allocator_type())
+            : chunk_alloc_{alloc} {
+        for (const auto &value : init) {
+            push_back(value);
+        }
+    }
+
+    unrolled_list(const unrolled_list &other)
+            : chunk_alloc_{node_traits::select_on_container_copy_construction(
+                      other.chunk_alloc_)} {
+        for (const auto &value : other) {
+            push_back(value);
+        }
+    }
+
+    unrolled_list(unrolled_list &&other) noexcept
+            : head_{std::exchange(other.head_, nullptr)},
+              tail_{std::exchange(other.tail_, nullptr)},
+              size_{std::exchange(other.size_, 0)},
+              chunk_alloc_{other.chunk_alloc_} {}
+
+    unrolled_list &operator=(const unrolled_list &other) {
+        if (this != &other) {
+            // Chunks go back to the allocator that handed them first
+            clear();
+            if constexpr (node_traits::propagate_on_container_copy_assignment::
+                                  value) {
+                chunk_alloc_ = other.chunk_alloc_;
+            }
+            for (const auto &value : other) {
+                push_back(value);
+            }
+        }
+        return *this;
+    }
+
+    unrolled_list &operator=(unrolled_list &&other) noexcept(
+            node_traits::propagate_on_container_move_assignment::value ||
+            node_traits::is_always_equal::value) {
+        if (this != &other) {
+            clear();
+            if constexpr (node_traits::propagate_on_container_move_assignment::
+                                  value) {
+                chunk_alloc_ = other.chunk_alloc_;
+                steal(other);
+            } else if (chunk_alloc_ == other.chunk_alloc_) {
+                steal(other);
+            } else {
+                // Chunks can't change hands, move the elements instead
+                for (auto &value : other) {
+                    emplace_back(std::move(value));
+                }
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~unrolled_list() {
+        clear();
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const {
+        return allocator_type(chunk_alloc_);
+    }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    const T &front() const {
+        return *head_->slot(head_->first);
+    }
+    T &front() {
+        return *head_->slot(head_->first);
+    }
+    const T &back() const {
+        return *tail_->slot(tail_->last - 1);
+    }
+    T &back() {
+        return *tail_->slot(tail_->last - 1);
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args) {
+        if (tail_ == nullptr || tail_->last == Chunk_Capacity) {
+            link_after(tail_, create_chunk(0));
+        }
+        auto *slot = tail_->slot(tail_->last);
+        std::construct_at(slot, std::forward<Args>(args)...);
+        ++tail_->last;
+        ++size_;
+        return *slot;
+    }
+
+    template <typename... Args>
+    T &emplace_front(Args &&...args) {
+        if (head_ == nullptr || head_->first == 0) {
+            link_after(nullptr, create_chunk(Chunk_Capacity));
+        }
+        auto *slot = head_->slot(head_->first - 1);
+        std::construct_at(slot, std::forward<Args>(args)...);
+        --head_->first;
+        ++size_;
+        return *slot;
+    }
+
+    void push_back(const T &value) {
+        emplace_back(value);
+    }
+    void push_back(T &&value) {
+        emplace_back(std::move(value));
+    }
+    void push_front(const T &value) {
+        emplace_front(value);
+    }
+    void push_front(T &&value) {
+        emplace_front(std::move(value));
+    }
+
+    void pop_back() {
+        if (empty()) {
+            return;
+        }
+        std::destroy_at(tail_->slot(--tail_->last));
+        --size_;
+        if (tail_->size() == 0) {
+            destroy_chunk(tail_);
+        }
+    }
+
+    void pop_front() {
+        if (empty()) {
+            return;
+        }
+        std::destroy_at(head_->slot(head_->first++));
+        --size_;
+        if (head_->size() == 0) {
+            destroy_chunk(head_);
+        }
+    }
+
+    // Constructs an element before pos, splitting its chunk when full
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        if (pos.chunk_ == nullptr) {
+            emplace_back(std::forward<Args>(args)...);
+            return iterator(tail_, tail_->last - 1, this);
+        }
+        if (pos.chunk_ == head_ && pos.index_ == head_->first) {
+            emplace_front(std::forward<Args>(args)...);
+            return begin();
+        }
+        T value(std::forward<Args>(args)...);
+        auto *c = pos.chunk_;
+        auto index = pos.index_;
+        if (c->size() == Chunk_Capacity) {
+            const auto mid = c->first + c->size() / 2;
+            auto *upper = create_chunk(0);
+            link_after(c, upper);
+            for (auto i = mid; i < c->last; ++i) {
+                std::construct_at(
+                        upper->slot(upper->last++), std::move(*c->slot(i)));
+                std::destroy_at(c->slot(i));
+            }
+            c->last = static_cast<std::uint32_t>(mid);
+            if (index > mid) {
+                index -= mid;
+                c = upper;
+            }
+        }
+        // Opens a slot at index by moving the shorter side of the chunk
+        // that has room to move
+        const auto room_left = c->first > 0;
+        const auto room_right = c->last < Chunk_Capacity;
+        if (room_right &&
+                (!room_left || c->last - index <= index - c->first)) {
+            if (index == c->last) {
+                std::construct_at(c->slot(index), std::move(value));
+            } else {
+                std::construct_at(
+                        c->slot(c->last), std::move(*c->slot(c->last - 1)));
+                std::move_backward(
+                        c->slot(index), c->slot(c->last - 1), c->slot(c->last));
+                *c->slot(index) = std::move(value);
+            }
+            ++c->last;
+        } else {
+            if (index == c->first) {
+                std::construct_at(c->slot(index - 1), std::move(value));
+            } else {
+                std::construct_at(c->slot(c->first - 1),
+                        std::move(*c->slot(c->first)));
+                std::move(c->slot(c->first + 1), c->slot(index),
+                        c->slot(c->first));
+                *c->slot(index - 1) = std::move(value);
+            }
+            --index;
+            --c->first;
+        }
+        ++size_;
+        return iterator(c, index, this);
+    }
+
+    iterator insert(const_iterator pos, const T &value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T &&value) {
+        return emplace(pos, std::move(value));
+    }
+
+    // Removes the element at pos, closing the gap from the shorter side
+    // of its chunk, then merges the chunk with a neighbour when it falls
+    // under half full. Returns the iterator to the element that followed it
+    iterator erase(const_iterator pos) {
+        auto *c = pos.chunk_;
+        auto index = pos.index_;
+        if (index - c->first < c->last - 1 - index) {
+            std::move_backward(
+                    c->slot(c->first), c->slot(index), c->slot(index + 1));
+            std::destroy_at(c->slot(c->first++));
+            ++index;
+        } else {
+            std::move(c->slot(index + 1), c->slot(c->last), c->slot(index));
+            std::destroy_at(c->slot(--c->last));
+        }
+        --size_;
+        if (c->size() == 0) {
+            auto *next = c->next;
+            destroy_chunk(c);
+            return iterator(next, next == nullptr ? 0 : next->first, this);
+        }
+        // The element that followed, counted from the start of its chunk
+        auto rank = index - c->first;
+        if (c->size() < Chunk_Capacity / 2) {
+            if (c->next != nullptr &&
+                    c->size() + c->next->size() <= Chunk_Capacity) {
+                absorb_next(c);
+            } else if (c->previous != nullptr &&
+                    c->previous->size() + c->size() <= Chunk_Capacity) {
+                rank += c->previous->size();
+                c = c->previous;
+                absorb_next(c);
+            }
+        }
+        if (c->first + rank == c->last) {
+            auto *next = c->next;
+            return iterator(next, next == nullptr ? 0 : next->first, this);
+        }
+        return iterator(c, c->first + rank, this);
+    }
+
+    void clear() {
+        while (head_ != nullptr) {
+            std::destroy(head_->slot(head_->first), head_->slot(head_->last));
+            destroy_chunk(head_);
+        }
+        size_ = 0;
+    }
+
+    // Number of chunks, for occupancy checks
+    [[nodiscard]] size_type chunk_count() const noexcept {
+        size_type count{};
+        for (auto *c = head_; c != nullptr; c = c->next) {
+            ++count;
+        }
+        return count;
+    }
+
+    iterator begin() noexcept {
+        return iterator(head_, head_ == nullptr ? 0 : head_->first, this);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(
+                head_, head_ == nullptr ? 0 : head_->first, this);
+    }
+    iterator end() noexcept {
+        return iterator(nullptr, 0, this);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(nullptr, 0, this);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+ private:
+    using chunk_allocator_type = typename std::allocator_traits<
+            allocator_type>::template rebind_alloc<chunk>;
+    using node_traits = std::allocator_traits<chunk_allocator_type>;
+
+    chunk *head_ = nullptr;
+    chunk *tail_ = nullptr;
+    size_type size_{0};
+    chunk_allocator_type chunk_alloc_{};
+
+    // Empty chunk whose elements will start at slot first
+    chunk *create_chunk(const std::size_t first) {
+        auto *c = std::to_address(node_traits::allocate(chunk_alloc_, 1));
+        ::new (static_cast<void *>(c)) chunk;
+        c->first = c->last = static_cast<std::uint32_t>(first);
+        return c;
+    }
+
+    // Unlinks an emptied chunk and frees it
+    void destroy_chunk(chunk *c) noexcept {
+        (c->previous == nullptr ? head_ : c->previous->next) = c->next;
+        (c->next == nullptr ? tail_ : c->next->previous) = c->previous;
+        c->~chunk();
+        node_traits::deallocate(chunk_alloc_, c, 1);
+    }
+
+    void steal(unrolled_list &other) noexcept {
+        head_ = std::exchange(other.head_, nullptr);
+        tail_ = std::exchange(other.tail_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Moves the elements of c down to start at slot 0
+    void compact(chunk *c) {
+        const std::size_t shift = c->first;
+        const auto count = c->size();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i < shift) {
+                std::construct_at(c->slot(i), std::move(*c->slot(i + shift)));
+            } else {
+                *c->slot(i) = std::move(*c->slot(i + shift));
+            }
+        }
+        std::destroy(c->slot(std::max(count, shift)), c->slot(c->last));
+        c->first = 0;
+        c->last = static_cast<std::uint32_t>(count);
+    }
+
+    // Appends the elements of the chunk after c to c and frees that chunk.
+    // Both hold at most Chunk_Capacity elements together
+    void absorb_next(chunk *c) {
+        auto *next = c->next;
+        if (Chunk_Capacity - c->last < next->size()) {
+            compact(c);
+        }
+        for (auto i = next->first; i < next->last; ++i) {
+            std::construct_at(c->slot(c->last++), std::move(*next->slot(i)));
+        }
+        std::destroy(next->slot(next->first), next->slot(next->last));
+        destroy_chunk(next);
+    }
+
+    // Links c after previous, at the front when previous is null
+    void link_after(chunk *previous, chunk *c) noexcept {
+        auto *next = previous == nullptr ? head_ : previous->next;
+        c->previous = previous;
+        c->next = next;
+        (previous == nullptr ? head_ : previous->next) = c;
+        (next == nullptr ? tail_ : next->previous) = c;
+    }
+};
+
+}  // namespace jtl
@@ -0,0 +1,124 @@
+#include "intrusive_list.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct timer {
+    int id;
+    jtl::list_hook<timer> by_deadline;
+    jtl::list_hook<timer> by_owner;
+};
+
+using deadline_list = jtl::intrusive_list<timer, &timer::by_deadline>;
+using owner_list = jtl::intrusive_list<timer, &timer::by_owner>;
+
+std::vector<int> ids(const auto &l) {
+    std::vector<int> result;
+    for (const auto &t : l) {
+        result.push_back(t.id);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(IntrusiveListTest, Empty) {
+    deadline_list l;
+    EXPECT_TRUE(l.empty() && l.size() == 0 && l.begin() == l.end());
+}
+
+TEST(IntrusiveListTest, PushPop) {
+    std::array<timer, 4> timers{{{0, {}, {}}, {1, {}, {}}, {2, {}, {}},
+            {3, {}, {}}}};
+    deadline_list l;
+    l.push_back(timers[1]);
+    l.push_back(timers[2]);
+    l.push_front(timers[0]);
+    l.push_back(timers[3]);
+    EXPECT_EQ(ids(l), (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(&l.front(), &timers[0]);
+    EXPECT_EQ(&l.back(), &timers[3]);
+    l.pop_front();
+    l.pop_back();
+    EXPECT_EQ(ids(l), (std::vector<int>{1, 2}));
+    EXPECT_EQ(timers[0].by_deadline.next, nullptr);
+    EXPECT_EQ(timers[3].by_deadline.previous, nullptr);
+}
+
+TEST(IntrusiveListTest, EraseFromObject) {
+    std::array<timer, 5> timers{};
+    deadline_list l;
+    for (auto i = 0; i < 5; ++i) {
+        timers[i].id = i;
+        l.push_back(timers[i]);
+    }
+    const auto next = l.erase(timers[2]);
+    EXPECT_EQ(next->id, 3);
+    l.erase(timers[0]);
+    l.erase(timers[4]);
+    EXPECT_EQ(ids(l), (std::vector<int>{1, 3}));
+    EXPECT_EQ(l.size(), 2u);
+    l.insert(l.iterator_to(timers[3]), timers[2]);
+    EXPECT_EQ(ids(l), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(IntrusiveListTest, SeveralLists) {
+    std::array<timer, 4> timers{};
+    deadline_list by_deadline;
+    owner_list by_owner;
+    for (auto i = 0; i < 4; ++i) {
+        timers[i].id = i;
+        by_deadline.push_back(timers[i]);
+        by_owner.push_front(timers[i]);
+    }
+    by_deadline.erase(timers[1]);
+    EXPECT_EQ(ids(by_deadline), (std::vector<int>{0, 2, 3}));
+    EXPECT_EQ(ids(by_owner), (std::vector<int>{3, 2, 1, 0}));
+}
+
+TEST(IntrusiveListTest, Iterators) {
+    std::array<timer, 3> timers{};
+    deadline_list l;
+    for (auto i = 0; i < 3; ++i) {
+        timers[i].id = i;
+        l.push_back(timers[i]);
+    }
+    EXPECT_EQ(std::prev(l.end())->id, 2);
+    std::vector<int> reversed;
+    for (auto it = l.rbegin(); it != l.rend(); ++it) {
+        reversed.push_back(it->id);
+    }
+    EXPECT_EQ(reversed, (std::vector<int>{2, 1, 0}));
+    const auto &cl = l;
+    deadline_list::const_iterator it = l.begin();
+    EXPECT_EQ(it, cl.begin());
+    EXPECT_EQ(std::distance(cl.begin(), cl.end()), 3);
+    EXPECT_EQ(std::find_if(l.begin(), l.end(),
+                      [](const timer &t) { return t.id == 1; })
+                      ->id,
+            1);
+}
+
+TEST(IntrusiveListTest, MoveAndClear) {
+    std::array<timer, 3> timers{};
+    deadline_list l;
+    for (auto &t : timers) {
+        l.push_back(t);
+    }
+    deadline_list moved{std::move(l)};
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(moved.size(), 3u);
+    moved.clear();
+    EXPECT_TRUE(moved.empty());
+    EXPECT_TRUE(std::all_of(timers.begin(), timers.end(), [](const timer &t) {
+        return t.by_deadline.next == nullptr &&
+                t.by_deadline.previous == nullptr;
+    }));
+}
@@ -2,6 +2,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pool_allocator.hpp"
+
 TEST(ListTest, Empty) {
     EXPECT_TRUE(jtl::list<int>{}.size() == 0 && jtl::list<int>{}.empty());
 }
@@ -25,3 +33,184 @@ TEST(ListTest, PopBack) {
     l.pop_back();
     EXPECT_TRUE(l.empty());
 }
+
+TEST(ListTest, Iterate) {
+    jtl::list<int> l;
+    l.push_back(1);
+    auto count = 0;
+    for ([[maybe_unused]] const auto &el : l) {
+        ++count;
+    }
+    EXPECT_EQ(count, 1);
+}
+
+TEST(ListTest, PoolAllocator) {
+    jtl::list<std::string, jtl::pool_allocator<std::string>> l{
+            jtl::pool_allocator<std::string>{8}};
+    for (auto round = 0; round < 4; ++round) {
+        for (auto i = 0; i < 20; ++i) {
+            l.push_back(std::to_string(i));
+        }
+        while (!l.empty()) {
+            l.pop_back();
+        }
+    }
+    l.push_back("jtl");
+    EXPECT_TRUE(l.size() == 1 && l.front() == "jtl" &&
+            l.get_allocator().blocks_per_page() == 8);
+}
+
+TEST(ListTest, PoolAllocatorShared) {
+    // Lists built from one allocator get their nodes from its pools
+    const jtl::pool_allocator<int> alloc{4};
+    jtl::list<int, jtl::pool_allocator<int>> l{alloc};
+    jtl::list<int, jtl::pool_allocator<int>> l2{alloc};
+    l.push_back(1);
+    l2.push_back(2);
+    struct node_sized {
+        void *next;
+        void *previous;
+        int data;
+    };
+    const jtl::pool_allocator<node_sized> nodes{alloc};
+    EXPECT_TRUE(l.get_allocator() == alloc && l2.get_allocator() == alloc &&
+            nodes.pool().pages() == 1);
+}
+
+template <typename List>
+static std::vector<int> elements(List &l) {
+    std::vector<int> result;
+    for (const auto &el : l) {
+        result.push_back(el);
+    }
+    return result;
+}
+
+TEST(ListTest, PushPopFront) {
+    jtl::list<int> l;
+    l.push_front(2);
+    l.push_front(1);
+    l.push_back(3);
+    EXPECT_EQ(elements(l), (std::vector<int>{1, 2, 3}));
+    l.pop_front();
+    EXPECT_EQ(l.front(), 2);
+    l.pop_front();
+    l.pop_front();
+    EXPECT_TRUE(l.empty() && l.begin() == l.end());
+}
+
+TEST(ListTest, InsertErase) {
+    jtl::list<int> l;
+    l.push_back(1);
+    l.push_back(3);
+    auto it = l.insert(++l.begin(), 2);
+    EXPECT_EQ(*it, 2);
+    l.insert(l.end(), 4);
+    l.insert(l.begin(), 0);
+    EXPECT_EQ(elements(l), (std::vector<int>{0, 1, 2, 3, 4}));
+    it = l.erase(l.begin());
+    EXPECT_EQ(*it, 1);
+    it = l.erase(++it);
+    EXPECT_EQ(*it, 3);
+    EXPECT_EQ(l.erase(++it), l.end());
+    EXPECT_EQ(elements(l), (std::vector<int>{1, 3}));
+    EXPECT_EQ(l.size(), 2);
+}
+
+TEST(ListTest, Splice) {
+    jtl::list<int> a;
+    jtl::list<int> b;
+    for (auto i = 0; i < 4; ++i) {
+        a.push_back(i);
+        b.push_back(10 + i);
+    }
+    const auto *moved = &*++b.begin();
+    // Single node, the same node stays where it was
+    a.splice(a.end(), b, ++b.begin());
+    EXPECT_EQ(&a.back(), moved);
+    EXPECT_EQ(elements(a), (std::vector<int>{0, 1, 2, 3, 11}));
+    EXPECT_EQ(elements(b), (std::vector<int>{10, 12, 13}));
+    // Range up to the end
+    a.splice(++a.begin(), b, ++b.begin(), b.end());
+    EXPECT_EQ(elements(a), (std::vector<int>{0, 12, 13, 1, 2, 3, 11}));
+    EXPECT_EQ(a.size(), 7);
+    EXPECT_EQ(b.size(), 1);
+    // Within the same list
+    a.splice(a.begin(), a, ++++++a.begin(), a.end());
+    EXPECT_EQ(elements(a), (std::vector<int>{1, 2, 3, 11, 0, 12, 13}));
+    EXPECT_EQ(a.size(), 7);
+    a.splice(a.begin(), b);
+    EXPECT_EQ(a.front(), 10);
+    EXPECT_TRUE(b.empty() && a.size() == 8);
+}
+
+TEST(ListTest, SplicePoolAllocator) {
+    using pool_list_t =
+            jtl::list<std::string, jtl::pool_allocator<std::string>>;
+    const jtl::pool_allocator<std::string> alloc{4};
+    pool_list_t a{alloc};
+    a.push_back("kept");
+    {
+        // Same pools, the nodes outlive the list they came from
+        pool_list_t b{alloc};
+        for (auto i = 0; i < 10; ++i) {
+            b.push_back(std::to_string(i) + " long enough for the heap");
+        }
+        a.splice(a.end(), b, ++b.begin(), b.end());
+        a.splice(a.begin(), b);
+    }
+    EXPECT_TRUE(a.size() == 11 && a.front() == "0 long enough for the heap");
+    a.pop_front();
+    a.push_back("reused");
+
+    // Other pools, nothing moves
+    pool_list_t c{jtl::pool_allocator<std::string>{4}};
+    c.push_back("c");
+    EXPECT_THROW(a.splice(a.end(), c), std::invalid_argument);
+    EXPECT_THROW(a.splice(a.end(), c, c.begin()), std::invalid_argument);
+    EXPECT_THROW(a.merge(c), std::invalid_argument);
+    EXPECT_TRUE(a.size() == 11 && c.size() == 1 && c.front() == "c");
+}
+
+TEST(ListTest, Merge) {
+    jtl::list<int> a;
+    jtl::list<int> b;
+    for (const auto i : {1, 3, 5, 7}) {
+        a.push_back(i);
+    }
+    for (const auto i : {0, 3, 4, 8, 9}) {
+        b.push_back(i);
+    }
+    const auto *first_three = &*++a.begin();
+    a.merge(b);
+    EXPECT_EQ(elements(a), (std::vector<int>{0, 1, 3, 3, 4, 5, 7, 8, 9}));
+    EXPECT_EQ(&*++++a.begin(), first_three);
+    EXPECT_TRUE(b.empty() && a.size() == 9);
+}
+
+TEST(ListTest, Sort) {
+    jtl::list<std::pair<int, int>> l;
+    std::vector<std::pair<int, int>> expected;
+    for (auto i = 0; i < 1'000; ++i) {
+        const std::pair value{(i * 7919) % 31, i};
+        l.push_back(value);
+        expected.push_back(value);
+    }
+    const auto by_key = [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+    };
+    l.sort(by_key);
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    auto it = l.begin();
+    for (const auto &value : expected) {
+        ASSERT_EQ(*it, value);
+        ++it;
+    }
+    EXPECT_EQ(l.back(), expected.back());
+    std::vector<std::pair<int, int>> reversed;
+    for (auto rit = l.rbegin(); rit != l.rend(); ++rit) {
+        reversed.push_back(*rit);
+    }
+    EXPECT_TRUE(std::equal(reversed.rbegin(), reversed.rend(),
+            expected.begin(), expected.end()));
+}
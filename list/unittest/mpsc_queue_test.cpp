@@ -0,0 +1,118 @@
+#include "mpsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(MpscQueueTest, Empty) {
+    jtl::mpsc_queue<int> q;
+    int value{};
+    EXPECT_TRUE(q.empty());
+    EXPECT_FALSE(q.try_pop(value));
+}
+
+TEST(MpscQueueTest, Fifo) {
+    jtl::mpsc_queue<std::string> q;
+    for (auto i = 0; i < 100; ++i) {
+        q.push(std::to_string(i));
+    }
+    std::string value;
+    for (auto i = 0; i < 100; ++i) {
+        ASSERT_TRUE(q.try_pop(value));
+        EXPECT_EQ(value, std::to_string(i));
+    }
+    EXPECT_TRUE(q.empty());
+    // Left in the queue, freed by the destructor
+    q.emplace(3, 'x');
+}
+
+TEST(MpscQueueTest, Drain) {
+    jtl::mpsc_queue<int> q;
+    for (auto i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    std::vector<int> seen;
+    EXPECT_EQ(q.drain([&](int value) { seen.push_back(value); }, 4), 4u);
+    EXPECT_EQ(q.drain([&](int value) { seen.push_back(value); }), 6u);
+    EXPECT_EQ(seen, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(q.drain([](int) {}), 0u);
+}
+
+TEST(MpscQueueTest, TryPushRecycles) {
+    jtl::mpsc_queue<int> q;
+    EXPECT_FALSE(q.try_push(1));
+    q.reserve(2);
+    EXPECT_TRUE(q.try_push(1));
+    EXPECT_TRUE(q.try_push(2));
+    EXPECT_FALSE(q.try_push(3));
+    // Drained nodes go back to the free stack
+    EXPECT_EQ(q.drain([](int) {}), 2u);
+    EXPECT_TRUE(q.try_push(3));
+    EXPECT_TRUE(q.try_push(4));
+    int value{};
+    EXPECT_TRUE(q.try_pop(value) && value == 3);
+}
+
+// Hands out addresses with a top byte tag, like arm64 TBI
+template <typename T>
+struct tagged_allocator {
+    using value_type = T;
+    static constexpr std::uintptr_t Tag = std::uintptr_t{0x5a} << 56;
+
+    tagged_allocator() = default;
+    template <typename U>
+    tagged_allocator(const tagged_allocator<U> &) {}
+
+    T *allocate(const std::size_t n) {
+        return reinterpret_cast<T *>(reinterpret_cast<std::uintptr_t>(
+                std::allocator<T>{}.allocate(n)) | Tag);
+    }
+    void deallocate(T *p, const std::size_t n) {
+        std::allocator<T>{}.deallocate(reinterpret_cast<T *>(
+                reinterpret_cast<std::uintptr_t>(p) & ~Tag), n);
+    }
+    template <typename U>
+    bool operator==(const tagged_allocator<U> &) const {
+        return true;
+    }
+};
+
+TEST(MpscQueueTest, WideAddressesRefused) {
+    using queue_t = jtl::mpsc_queue<int, tagged_allocator<int>>;
+    EXPECT_THROW(queue_t{}, std::bad_alloc);
+}
+
+TEST(MpscQueueTest, Producers) {
+    constexpr auto Producers = 4;
+    constexpr auto Per_Producer = 20'000;
+    jtl::mpsc_queue<std::pair<int, int>> q;
+    std::vector<std::thread> producers;
+    for (auto p = 0; p < Producers; ++p) {
+        producers.emplace_back([&q, p] {
+            for (auto i = 0; i < Per_Producer; ++i) {
+                q.push({p, i});
+            }
+        });
+    }
+    // Every producer's elements come out in the order pushed
+    std::vector<int> next(Producers);
+    auto received = 0;
+    while (received < Producers * Per_Producer) {
+        received += static_cast<int>(q.drain([&](std::pair<int, int> item) {
+            ASSERT_EQ(item.second, next[item.first]);
+            ++next[item.first];
+        }));
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(next, std::vector<int>(Producers, Per_Producer));
+}
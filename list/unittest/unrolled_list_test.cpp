@@ -0,0 +1,263 @@
+#include "unrolled_list.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "pool_allocator.hpp"
+
+template <typename List>
+static std::vector<typename List::value_type> elements(const List &l) {
+    return {l.begin(), l.end()};
+}
+
+TEST(UnrolledListTest, Empty) {
+    jtl::unrolled_list<int> l;
+    EXPECT_TRUE(l.empty() && l.size() == 0 && l.begin() == l.end());
+    EXPECT_EQ(l.chunk_count(), 0u);
+}
+
+TEST(UnrolledListTest, PushPopBothEnds) {
+    jtl::unrolled_list<int, 64> l;
+    constexpr auto Capacity = jtl::unrolled_list<int, 64>::Chunk_Capacity;
+    for (auto i = 0; i < 100; ++i) {
+        l.push_back(i);
+        l.push_front(-i - 1);
+    }
+    EXPECT_EQ(l.size(), 200u);
+    EXPECT_EQ(l.front(), -100);
+    EXPECT_EQ(l.back(), 99);
+    EXPECT_EQ(l.chunk_count(), 2 * ((100 + Capacity - 1) / Capacity));
+    for (auto i = 0; i < 100; ++i) {
+        l.pop_back();
+        l.pop_front();
+    }
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.chunk_count(), 0u);
+}
+
+TEST(UnrolledListTest, InsertSplitsFullChunk) {
+    jtl::unrolled_list<int, 64> l;
+    constexpr auto Capacity = jtl::unrolled_list<int, 64>::Chunk_Capacity;
+    for (std::size_t i = 0; i < Capacity; ++i) {
+        l.push_back(static_cast<int>(i));
+    }
+    EXPECT_EQ(l.chunk_count(), 1u);
+    const auto it = l.insert(std::next(l.begin(), 3), 42);
+    EXPECT_EQ(*it, 42);
+    EXPECT_EQ(l.chunk_count(), 2u);
+    std::vector<int> expected(Capacity);
+    std::iota(expected.begin(), expected.end(), 0);
+    expected.insert(expected.begin() + 3, 42);
+    EXPECT_EQ(elements(l), expected);
+}
+
+// Counts the moves made of it
+struct Moved {
+    static inline std::size_t moves{};
+
+    int value;
+
+    explicit Moved(int v) : value{v} {}
+    Moved(const Moved &) = default;
+    Moved(Moved &&other) noexcept : value{other.value} {
+        ++moves;
+    }
+    Moved &operator=(const Moved &) = default;
+    Moved &operator=(Moved &&other) noexcept {
+        value = other.value;
+        ++moves;
+        return *this;
+    }
+    ~Moved() = default;
+};
+
+TEST(UnrolledListTest, InsertShiftsShorterSide) {
+    jtl::unrolled_list<Moved, 64> l;
+    for (auto i = 0; i < 8; ++i) {
+        l.emplace_back(i);
+    }
+    l.pop_front();
+    l.pop_front();
+    // Room on both sides of the single chunk, one element before pos
+    Moved::moves = 0;
+    const auto it = l.emplace(std::next(l.begin()), 42);
+    EXPECT_TRUE(it->value == 42 && Moved::moves == 2 && l.chunk_count() == 1);
+    std::vector<int> values;
+    for (const auto &m : l) {
+        values.push_back(m.value);
+    }
+    EXPECT_EQ(values, (std::vector<int>{2, 42, 3, 4, 5, 6, 7}));
+}
+
+TEST(UnrolledListTest, EraseMergesChunks) {
+    jtl::unrolled_list<int, 64> l;
+    constexpr auto Capacity = jtl::unrolled_list<int, 64>::Chunk_Capacity;
+    // Middle inserts leave every chunk about half full
+    for (auto i = 0; i < 1000; ++i) {
+        l.insert(std::next(l.begin(), l.size() / 2), i);
+    }
+    std::vector<int> expected;
+    auto i = 0;
+    for (auto it = l.begin(); it != l.end(); ++i) {
+        if (i % 10 == 0) {
+            expected.push_back(*it++);
+        } else {
+            it = l.erase(it);
+        }
+    }
+    EXPECT_EQ(elements(l), expected);
+    // Any two neighbours together hold more than a chunk, or one of them
+    // would have been merged into the other
+    EXPECT_LE(l.chunk_count(), 2 * l.size() / Capacity + 1);
+}
+
+TEST(UnrolledListTest, ChunksOnCacheLines) {
+    // 24 header bytes and five elements don't fill 256, pool blocks only
+    // land on cache lines if the chunk is padded and aligned to them
+    using element = std::array<char, 40>;
+    using list_t =
+            jtl::unrolled_list<element, 256, jtl::pool_allocator<element>>;
+    list_t l{jtl::pool_allocator<element>{8}};
+    for (std::size_t i = 0; i < 8 * list_t::Chunk_Capacity; ++i) {
+        l.push_back(element{});
+    }
+    constexpr auto Header_Bytes =
+            2 * sizeof(void *) + 2 * sizeof(std::uint32_t);
+    std::size_t i{};
+    for (const auto &value : l) {
+        if (i++ % list_t::Chunk_Capacity == 0) {
+            const auto address = reinterpret_cast<std::uintptr_t>(&value);
+            EXPECT_EQ((address - Header_Bytes) % jtl::Cache_Line_Bytes, 0u);
+        }
+    }
+}
+
+TEST(UnrolledListTest, Iterators) {
+    const jtl::unrolled_list<int, 64> l{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+            12};
+    EXPECT_EQ(std::distance(l.begin(), l.end()), 12);
+    EXPECT_EQ(*std::prev(l.end()), 12);
+    std::vector<int> reversed(l.rbegin(), l.rend());
+    EXPECT_EQ(reversed.front(), 12);
+    EXPECT_EQ(reversed.back(), 1);
+    auto copy = l;
+    *copy.begin() = 0;
+    EXPECT_EQ(l.front(), 1);
+    EXPECT_EQ(copy.front(), 0);
+}
+
+// Random edits checked against std::list, one element per chunk and
+// several
+template <std::size_t ChunkBytes>
+static void against_std_list() {
+    std::mt19937 gen{ChunkBytes};
+    jtl::unrolled_list<std::string, ChunkBytes> l;
+    std::list<std::string> expected;
+    for (auto step = 0; step < 3'000; ++step) {
+        const auto value = std::to_string(step) + " long enough for the heap";
+        const auto pos = expected.empty() ? 0 : gen() % expected.size();
+        switch (gen() % 6) {
+        case 0:
+            l.push_back(value);
+            expected.push_back(value);
+            break;
+        case 1:
+            l.push_front(value);
+            expected.push_front(value);
+            break;
+        case 2:
+        case 3: {
+            const auto it = l.insert(std::next(l.begin(), pos), value);
+            EXPECT_EQ(*it, value);
+            expected.insert(std::next(expected.begin(), pos), value);
+            break;
+        }
+        default:
+            if (!expected.empty()) {
+                const auto it = l.erase(std::next(l.begin(), pos));
+                const auto next =
+                        expected.erase(std::next(expected.begin(), pos));
+                EXPECT_EQ(it == l.end(), next == expected.end());
+                if (next != expected.end()) {
+                    EXPECT_EQ(*it, *next);
+                }
+            }
+        }
+        ASSERT_EQ(l.size(), expected.size());
+    }
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin()));
+    EXPECT_TRUE(std::equal(l.rbegin(), l.rend(), expected.rbegin()));
+}
+
+TEST(UnrolledListTest, AgainstStdList) {
+    against_std_list<64>();
+    against_std_list<256>();
+}
+
+// Pool allocator that stays with its list on assignment
+template <typename T>
+struct sticky_pool_allocator : jtl::pool_allocator<T> {
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = sticky_pool_allocator<U>;
+    };
+
+    using jtl::pool_allocator<T>::pool_allocator;
+    template <typename U>
+    explicit sticky_pool_allocator(const sticky_pool_allocator<U> &other)
+            : jtl::pool_allocator<T>(other) {}
+};
+
+TEST(UnrolledListTest, AllocatorPropagation) {
+    using pool_list_t = jtl::unrolled_list<int, 64, jtl::pool_allocator<int>>;
+    const jtl::pool_allocator<int> alloc{4};
+    const jtl::pool_allocator<int> alloc2{4};
+    pool_list_t l{{1, 2, 3}, alloc};
+    pool_list_t l2{{4}, alloc2};
+    l2 = l;
+    EXPECT_TRUE(l2.get_allocator() == alloc && elements(l2) == elements(l));
+    pool_list_t l3{alloc2};
+    l3 = std::move(l2);
+    EXPECT_TRUE(l3.get_allocator() == alloc && l3.size() == 3);
+
+    using sticky_list_t =
+            jtl::unrolled_list<int, 64, sticky_pool_allocator<int>>;
+    const sticky_pool_allocator<int> sticky{4};
+    const sticky_pool_allocator<int> sticky2{4};
+    sticky_list_t l4{{1, 2, 3}, sticky};
+    sticky_list_t l5{sticky2};
+    l5 = l4;
+    EXPECT_TRUE(l5.get_allocator() == sticky2 && elements(l5) == elements(l4));
+    sticky_list_t l6{sticky2};
+    l6 = std::move(l4);
+    EXPECT_TRUE(l6.get_allocator() == sticky2 && l6.size() == 3 &&
+            l4.empty());
+}
+
+TEST(UnrolledListTest, PoolAllocator) {
+    jtl::unrolled_list<int, 128, jtl::pool_allocator<int>> l{
+            jtl::pool_allocator<int>{4}};
+    for (auto round = 0; round < 4; ++round) {
+        for (auto i = 0; i < 200; ++i) {
+            l.push_back(i);
+        }
+        l.clear();
+    }
+    l.push_back(7);
+    EXPECT_TRUE(l.size() == 1 && l.front() == 7 &&
+            l.get_allocator().blocks_per_page() == 4);
+}
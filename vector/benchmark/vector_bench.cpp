@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "allocator.hpp"
+#include "iterator.hpp"
+#include "mmap_allocator.hpp"
+#include "ring_buffer.hpp"
+#include "vector.hpp"
+
+template <typename T>
+using jtl_vector_t =
+        jtl::vector<T, jtl::allocator<T>, jtl::RandomAccessIterator<T>>;
+
+// String payload that counts how many times it gets deep copied
+// Nothrow_Move selects whether the vector is allowed to move it on growth
+template <bool Nothrow_Move>
+struct Payload {
+    static inline std::size_t copies{};
+
+    std::string value;
+
+    Payload() = default;
+    explicit Payload(std::string v) : value{std::move(v)} {}
+    Payload(const Payload &other) : value{other.value} {
+        ++copies;
+    }
+    Payload(Payload &&other) noexcept(Nothrow_Move)
+            : value{std::move(other.value)} {}
+    Payload &operator=(const Payload &other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    Payload &operator=(Payload &&other) noexcept(Nothrow_Move) {
+        value = std::move(other.value);
+        return *this;
+    }
+    ~Payload() = default;
+};
+
+template <typename T>
+static void BM_PushBackGrowth(benchmark::State &state) {
+    const auto elements = static_cast<std::size_t>(state.range(0));
+    const std::string value(64, 'x');
+    T::copies = 0;
+    for (auto _ : state) {
+        jtl_vector_t<T> vec;
+        for (std::size_t i = 0; i < elements; ++i) {
+            vec.emplace_back(value);
+        }
+        auto moved{std::move(vec)};
+        benchmark::DoNotOptimize(moved);
+    }
+    state.counters["copies"] = benchmark::Counter(static_cast<double>(T::copies),
+            benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_TEMPLATE(BM_PushBackGrowth, Payload<false>)->Range(1 << 6, 1 << 14);
+BENCHMARK_TEMPLATE(BM_PushBackGrowth, Payload<true>)->Range(1 << 6, 1 << 14);
+
+// Growth of a vector of PODs: std::allocator relocates with memcpy into a
+// new block, jtl::allocator lets realloc extend or remap the block
+template <typename Alloc>
+static void BM_PodGrowth(benchmark::State &state) {
+    const auto elements = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        jtl::vector<std::uint64_t, Alloc,
+                jtl::RandomAccessIterator<std::uint64_t>>
+                vec;
+        for (std::size_t i = 0; i < elements; ++i) {
+            vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(vec[elements - 1]);
+    }
+    state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_PodGrowth, std::allocator<std::uint64_t>)
+        ->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_PodGrowth, jtl::allocator<std::uint64_t>)
+        ->Range(1 << 10, 1 << 24);
+
+// Random reads over a large table, mmap_allocator backs it with huge pages
+// so most lookups avoid a TLB miss
+template <typename Alloc>
+static void BM_RandomAccess(benchmark::State &state) {
+    const auto elements = static_cast<std::size_t>(state.range(0));
+    jtl::vector<std::uint64_t, Alloc, jtl::RandomAccessIterator<std::uint64_t>>
+            vec;
+    vec.resize(elements);
+    for (std::size_t i = 0; i < elements; ++i) {
+        vec[i] = i;
+    }
+    std::uint64_t idx{};
+    std::uint64_t sum{};
+    for (auto _ : state) {
+        // Cheap LCG, keeps the access pattern unpredictable for the
+        // prefetcher
+        idx = idx * 6364136223846793005ULL + 1442695040888963407ULL;
+        sum += vec[(idx >> 17) % elements];
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_RandomAccess, jtl::allocator<std::uint64_t>)
+        ->Range(1 << 16, 1 << 26);
+BENCHMARK_TEMPLATE(BM_RandomAccess, jtl::mmap_allocator<std::uint64_t>)
+        ->Range(1 << 16, 1 << 26);
+BENCHMARK_TEMPLATE(BM_RandomAccess,
+        jtl::mmap_allocator<std::uint64_t, jtl::Huge_Page_Size, true>)
+        ->Range(1 << 16, 1 << 26);
+
+// One producer thread hands 2^16 integers to the consumer through an
+// spsc_ring, Batch at a time: each batch publishes its index once
+template <std::size_t Batch>
+static void BM_RingHandoff(benchmark::State &state) {
+    constexpr std::uint64_t Count = 1 << 16;
+    jtl::spsc_ring<std::uint64_t> ring{1024};
+    for (auto _ : state) {
+        std::thread producer{[&] {
+            std::uint64_t batch[Batch];
+            for (std::uint64_t i = 0; i < Count;) {
+                for (std::size_t j = 0; j < Batch; ++j) {
+                    batch[j] = i + j;
+                }
+                const auto n = ring.try_push_n(batch, Batch);
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                i += n;
+            }
+        }};
+        std::uint64_t batch[Batch];
+        std::uint64_t received{};
+        std::uint64_t sum{};
+        while (received < Count) {
+            const auto n = ring.try_pop_n(batch, Batch);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            for (std::size_t j = 0; j < n; ++j) {
+                sum += batch[j];
+            }
+            received += n;
+        }
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * Count);
+}
+
+BENCHMARK_TEMPLATE(BM_RingHandoff, 1)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingHandoff, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief jtl::vector of trivially copyable elements living in a file
+ *  The file is mapped shared and starts with a small header holding the
+ *  size, capacity, element size and a caller chosen layout tag. Reopening
+ *  the file gives the elements back as they were, no deserialization
+ *  involved, and processes mapping the same file share its pages.
+ *  Growth extends the file with ftruncate and the mapping with mremap.
+ *  Opened read only, an existing file is mapped without write access, so
+ *  prebuilt tables on read only media can be shared as they are
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector.hpp"
+
+namespace jtl {
+
+enum class map_mode {
+    read_write,  // Creates the file when missing, the vector can grow
+    read_only    // The file must exist, the vector can't be modified
+};
+
+template <typename T, typename Iterator = typename std::vector<T>::iterator,
+        Growth_Policy Growth = growth_2x>
+class mapped_vector {
+    static_assert(std::is_trivially_copyable_v<T>,
+            "only trivially copyable elements can be stored as raw bytes");
+
+ public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = Iterator;
+    using const_iterator = const iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr std::uint64_t Magic = 0x434556504d4c544aULL;  // JTLMPVEC
+
+    // On-disk header, the elements start right after it
+    struct alignas(64) header {
+        std::uint64_t magic;
+        std::uint64_t layout;
+        std::uint64_t element_size;
+        std::uint64_t size;
+        std::uint64_t capacity;
+    };
+
+    static_assert(alignof(T) <= alignof(header),
+            "elements must fit the alignment of the file header");
+
+ private:
+    int fd_{-1};
+    header *header_{nullptr};
+    std::size_t mapped_bytes_{};
+    map_mode mode_{map_mode::read_write};
+
+    [[noreturn]] static void throw_errno(const char *what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static constexpr std::size_t file_size(std::size_t capacity) {
+        return sizeof(header) + capacity * sizeof(T);
+    }
+
+    pointer elements() const noexcept {
+        return reinterpret_cast<pointer>(header_ + 1);
+    }
+
+    void map(std::size_t bytes) {
+        const auto prot = mode_ == map_mode::read_only
+                ? PROT_READ
+                : PROT_READ | PROT_WRITE;
+        auto ptr = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            throw_errno("mapped_vector: mmap");
+        }
+        header_ = static_cast<header *>(ptr);
+        mapped_bytes_ = bytes;
+    }
+
+    void unmap() noexcept {
+        if (header_ != nullptr) {
+            ::munmap(header_, mapped_bytes_);
+            header_ = nullptr;
+        }
+        if (fd_ != -1) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void check_writable() const {
+        if (mode_ == map_mode::read_only) {
+            throw std::logic_error("mapped_vector: opened read only");
+        }
+    }
+
+    // File and mapping always have the same length
+    void remap(std::size_t new_cap) {
+        check_writable();
+        const auto bytes = file_size(new_cap);
+        if (new_cap > header_->capacity &&
+                ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw_errno("mapped_vector: ftruncate");
+        }
+        auto ptr = ::mremap(header_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (ptr == MAP_FAILED) {
+            throw_errno("mapped_vector: mremap");
+        }
+        header_ = static_cast<header *>(ptr);
+        mapped_bytes_ = bytes;
+        if (new_cap < header_->capacity &&
+                ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw_errno("mapped_vector: ftruncate");
+        }
+        header_->capacity = new_cap;
+    }
+
+    void grow_for(const size_type count) {
+        check_writable();
+        const auto required = size() + count;
+        if (required > capacity()) {
+            remap(std::max(required,
+                    static_cast<size_type>(Growth::next_capacity(capacity()))));
+        }
+    }
+
+    void check_layout(std::uint64_t layout) const {
+        if (header_->magic != Magic || header_->element_size != sizeof(T) ||
+                header_->layout != layout) {
+            throw std::runtime_error("mapped_vector: layout mismatch");
+        }
+        if (file_size(header_->capacity) != mapped_bytes_ ||
+                header_->size > header_->capacity) {
+            throw std::runtime_error("mapped_vector: truncated file");
+        }
+    }
+
+ public:
+    // Opens the vector stored at path, creating an empty one when the file
+    // doesn't exist and mode allows writes. layout has to match the tag the
+    // file was created with
+    explicit mapped_vector(const std::filesystem::path &path,
+            std::uint64_t layout = 0, map_mode mode = map_mode::read_write)
+            : mode_{mode} {
+        fd_ = mode == map_mode::read_only
+                ? ::open(path.c_str(), O_RDONLY | O_CLOEXEC)
+                : ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ == -1) {
+            throw_errno("mapped_vector: open");
+        }
+        try {
+            struct stat st {};
+            if (::fstat(fd_, &st) != 0) {
+                throw_errno("mapped_vector: fstat");
+            }
+            if (st.st_size == 0 && mode == map_mode::read_write) {
+                if (::ftruncate(fd_, sizeof(header)) != 0) {
+                    throw_errno("mapped_vector: ftruncate");
+                }
+                map(sizeof(header));
+                *header_ = header{Magic, layout, sizeof(T), 0, 0};
+            } else if (static_cast<std::size_t>(st.st_size) < sizeof(header)) {
+                throw std::runtime_error("mapped_vector: truncated file");
+            } else {
+                map(static_cast<std::size_t>(st.st_size));
+                check_layout(layout);
+            }
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    mapped_vector(const mapped_vector &) = delete;
+    mapped_vector &operator=(const mapped_vector &) = delete;
+
+    mapped_vector(mapped_vector &&other) noexcept
+            : fd_{std::exchange(other.fd_, -1)},
+              header_{std::exchange(other.header_, nullptr)},
+              mapped_bytes_{std::exchange(other.mapped_bytes_, 0)},
+              mode_{other.mode_} {}
+
+    mapped_vector &operator=(mapped_vector &&other) noexcept {
+        // Protection against self assignment
+        if (this != &other) {
+            unmap();
+            fd_ = std::exchange(other.fd_, -1);
+            header_ = std::exchange(other.header_, nullptr);
+            mapped_bytes_ = std::exchange(other.mapped_bytes_, 0);
+            mode_ = other.mode_;
+        }
+        return *this;
+    }
+
+    ~mapped_vector() {
+        unmap();
+    }
+
+    bool operator==(const mapped_vector &other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+    bool operator!=(const mapped_vector &other) const {
+        return !(*this == other);
+    }
+
+    auto &operator[](std::size_t index) const {
+        return elements()[index];
+    }
+    auto &operator[](std::size_t index) {
+        return elements()[index];
+    }
+
+    [[nodiscard]] pointer data() const noexcept {
+        return elements();
+    }
+
+    [[nodiscard]] std::uint64_t layout() const noexcept {
+        return header_->layout;
+    }
+
+    // Elements of a read only vector must not be written through operator[]
+    // nor data(), the pages are mapped without write access
+    [[nodiscard]] bool read_only() const noexcept {
+        return mode_ == map_mode::read_only;
+    }
+
+    void push_back(const value_type &d) {
+        emplace_back(d);
+    }
+
+    reference emplace_back(auto &&...params) {
+        // params may refer to an element of the mapping mremap moves away
+        const value_type value(std::forward<decltype(params)>(params)...);
+        grow_for(1);
+        std::construct_at(elements() + header_->size, value);
+        return elements()[header_->size++];
+    }
+
+    template <std::ranges::input_range Range>
+    void append_range(Range &&range) {
+        if constexpr (std::ranges::sized_range<Range>) {
+            grow_for(static_cast<size_type>(std::ranges::size(range)));
+        }
+        for (auto &&el : range) {
+            emplace_back(std::forward<decltype(el)>(el));
+        }
+    }
+
+    iterator begin() const {
+        return iterator(elements());
+    }
+
+    iterator end() const {
+        return iterator(elements() + header_->size);
+    }
+
+    const_iterator cbegin() const {
+        return const_iterator(elements());
+    }
+
+    const_iterator cend() const {
+        return const_iterator(elements() + header_->size);
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    size_type size() const noexcept {
+        return static_cast<size_type>(header_->size);
+    }
+
+    size_type capacity() const noexcept {
+        return static_cast<size_type>(header_->capacity);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return header_->size == 0;
+    }
+
+    void resize(const size_type new_size) {
+        check_writable();
+        reserve(new_size);
+        if (new_size > size()) {
+            std::fill(elements() + size(), elements() + new_size, value_type{});
+        }
+        header_->size = new_size;
+    }
+
+    void reserve(const size_type new_cap) {
+        if (new_cap > capacity()) {
+            remap(new_cap);
+        }
+    }
+
+    void shrink_to_fit() {
+        if (size() < capacity()) {
+            remap(size());
+        }
+    }
+
+    void clear() {
+        check_writable();
+        header_->size = 0;
+    }
+
+    // Flushes the dirty pages to the file, the kernel does it on its own
+    // pace otherwise
+    void sync() const {
+        if (::msync(header_, mapped_bytes_, MS_SYNC) != 0) {
+            throw_errno("mapped_vector: msync");
+        }
+    }
+};
+
+}  // namespace jtl
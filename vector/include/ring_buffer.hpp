@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief Bounded lock-free rings passing elements between threads
+ *  Slots live in a jtl::vector obtained from Alloc, their number being
+ *  the capacity rounded up to a power of two so positions wrap with a
+ *  mask. Head and tail are free running counters kept on cache lines of
+ *  their own. None of the calls blocks nor allocates, the try_ ones
+ *  fail or come short when the ring is full or empty.
+ *  spsc_ring serves one producer and one consumer: each side reads the
+ *  other's counter only when its cached copy says the ring is full or
+ *  empty. mpmc_ring is Dmitry Vyukov's bounded queue, every slot holds
+ *  a sequence number telling which lap may write or read it next, and
+ *  threads claim positions with a compare and swap of head or tail.
+ *  Once claimed a slot must be filled or emptied, so mpmc_ring requires
+ *  T to move without throwing
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "common.hpp"
+#include "vector.hpp"
+
+namespace jtl {
+
+template <typename T, typename Alloc = jtl::allocator<T>>
+class alignas(Cache_Line_Bytes) spsc_ring {
+    struct slot {
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *data() noexcept {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    using slot_allocator_type = typename std::allocator_traits<
+            Alloc>::template rebind_alloc<slot>;
+
+ public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    explicit spsc_ring(const size_type capacity,
+            const allocator_type &alloc = allocator_type())
+            : slots_(slot_allocator_type(alloc)),
+              mask_{std::bit_ceil(std::max<size_type>(capacity, 1)) - 1} {
+        slots_.resize(mask_ + 1);
+    }
+
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring &operator=(const spsc_ring &) = delete;
+
+    // Neither side may be running
+    ~spsc_ring() {
+        const auto tail = tail_.load(std::memory_order_acquire);
+        for (auto head = head_.load(std::memory_order_relaxed); head != tail;
+                ++head) {
+            std::destroy_at(at(head));
+        }
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const {
+        return allocator_type(slots_.get_allocator());
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // Exact from either side when the other one is idle
+    [[nodiscard]] size_type size() const noexcept {
+        return tail_.load(std::memory_order_acquire) -
+                head_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Producer
+    template <typename... Args>
+    bool try_emplace(Args &&...args) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (room(tail) == 0) {
+            return false;
+        }
+        std::construct_at(at(tail), std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T &value) {
+        return try_emplace(value);
+    }
+    bool try_push(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    // Producer: pushes up to count elements from first, published
+    // together, and returns how many
+    template <std::input_iterator InputIter>
+    size_type try_push_n(InputIter first, const size_type count) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        const auto n = std::min(count, room(tail, count));
+        size_type i{};
+        try {
+            for (; i < n; ++i, ++first) {
+                std::construct_at(at(tail + i), *first);
+            }
+        } catch (...) {
+            tail_.store(tail + i, std::memory_order_release);
+            throw;
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer
+    bool try_pop(T &value) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (ready(head) == 0) {
+            return false;
+        }
+        auto element = at(head);
+        value = std::move(*element);
+        std::destroy_at(element);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: moves up to max elements to out, the slots being handed
+    // back together, and returns how many
+    template <typename OutputIter>
+    size_type try_pop_n(OutputIter out, const size_type max) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto n = std::min(max, ready(head, max));
+        size_type i{};
+        try {
+            for (; i < n; ++i, ++out) {
+                auto element = at(head + i);
+                *out = std::move(*element);
+                std::destroy_at(element);
+            }
+        } catch (...) {
+            head_.store(head + i, std::memory_order_release);
+            throw;
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+ private:
+    jtl::vector<slot, slot_allocator_type> slots_;
+    size_type mask_;
+    // Consumer side
+    alignas(Cache_Line_Bytes) std::atomic<size_type> head_{0};
+    size_type cached_tail_{0};
+    // Producer side
+    alignas(Cache_Line_Bytes) std::atomic<size_type> tail_{0};
+    size_type cached_head_{0};
+
+    T *at(const size_type position) noexcept {
+        return slots_[position & mask_].data();
+    }
+
+    // Free slots, head is reloaded only when the cached one leaves fewer
+    // than wanted
+    size_type room(const size_type tail, const size_type wanted = 1) {
+        if (capacity() - (tail - cached_head_) < wanted) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        return capacity() - (tail - cached_head_);
+    }
+
+    // Filled slots, tail is reloaded likewise
+    size_type ready(const size_type head, const size_type wanted = 1) {
+        if (cached_tail_ - head < wanted) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        return cached_tail_ - head;
+    }
+};
+
+template <typename T, typename Alloc = jtl::allocator<T>>
+class alignas(Cache_Line_Bytes) mpmc_ring {
+    static_assert(std::is_nothrow_move_constructible_v<T> &&
+                    std::is_nothrow_move_assignable_v<T>,
+            "mpmc_ring: claimed slots can't be given up");
+
+    // The slot is free for position p when sequence == p and holds the
+    // element of position p when sequence == p + 1
+    struct slot {
+        std::size_t sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *data() noexcept {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+
+        std::atomic_ref<std::size_t> seq() noexcept {
+            return std::atomic_ref<std::size_t>{sequence};
+        }
+    };
+
+    using slot_allocator_type = typename std::allocator_traits<
+            Alloc>::template rebind_alloc<slot>;
+
+ public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    explicit mpmc_ring(const size_type capacity,
+            const allocator_type &alloc = allocator_type())
+            : slots_(slot_allocator_type(alloc)),
+              mask_{std::bit_ceil(std::max<size_type>(capacity, 1)) - 1} {
+        slots_.resize(mask_ + 1);
+        for (size_type i = 0; i <= mask_; ++i) {
+            slots_[i].sequence = i;
+        }
+    }
+
+    mpmc_ring(const mpmc_ring &) = delete;
+    mpmc_ring &operator=(const mpmc_ring &) = delete;
+
+    // No thread may be running
+    ~mpmc_ring() {
+        const auto tail = tail_.load(std::memory_order_acquire);
+        for (auto head = head_.load(std::memory_order_relaxed); head != tail;
+                ++head) {
+            std::destroy_at(slots_[head & mask_].data());
+        }
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const {
+        return allocator_type(slots_.get_allocator());
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // A snapshot, elements may be claimed but not yet filled or emptied
+    [[nodiscard]] size_type size() const noexcept {
+        const auto head = head_.load(std::memory_order_acquire);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // The element is built before a slot is claimed, a throwing
+    // constructor leaves the ring untouched
+    template <typename... Args>
+    bool try_emplace(Args &&...args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args &&...>) {
+            return push_one(std::forward<Args>(args)...);
+        } else {
+            T value(std::forward<Args>(args)...);
+            return push_one(std::move(value));
+        }
+    }
+
+    bool try_push(const T &value) {
+        return try_emplace(value);
+    }
+    bool try_push(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    // Claims up to count consecutive slots with a single compare and
+    // swap and fills them from first, returns how many
+    template <std::input_iterator InputIter>
+        requires std::is_nothrow_constructible_v<T,
+                std::iter_reference_t<InputIter>>
+    size_type try_push_n(InputIter first, const size_type count) {
+        const auto [tail, n] = claim(tail_, count, 0);
+        for (size_type i = 0; i < n; ++i, ++first) {
+            auto &s = slots_[(tail + i) & mask_];
+            std::construct_at(s.data(), *first);
+            s.seq().store(tail + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    bool try_pop(T &value) {
+        return try_pop_n(&value, 1) == 1;
+    }
+
+    // Claims up to max consecutive filled slots the same way and moves
+    // them to out, whose assignments must not throw either
+    template <typename OutputIter>
+        requires(noexcept(*std::declval<OutputIter &>() = std::declval<T>()))
+    size_type try_pop_n(OutputIter out, const size_type max) {
+        const auto [head, n] = claim(head_, max, 1);
+        for (size_type i = 0; i < n; ++i, ++out) {
+            auto &s = slots_[(head + i) & mask_];
+            *out = std::move(*s.data());
+            std::destroy_at(s.data());
+            s.seq().store(head + i + capacity(), std::memory_order_release);
+        }
+        return n;
+    }
+
+ private:
+    jtl::vector<slot, slot_allocator_type> slots_;
+    size_type mask_;
+    alignas(Cache_Line_Bytes) std::atomic<size_type> head_{0};
+    alignas(Cache_Line_Bytes) std::atomic<size_type> tail_{0};
+
+    template <typename... Args>
+    bool push_one(Args &&...args) noexcept {
+        const auto [tail, n] = claim(tail_, 1, 0);
+        if (n == 0) {
+            return false;
+        }
+        auto &s = slots_[tail & mask_];
+        std::construct_at(s.data(), std::forward<Args>(args)...);
+        s.seq().store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    struct claimed {
+        size_type first;
+        size_type count;
+    };
+
+    // Moves counter past the run of up to wanted slots, from its current
+    // position, whose sequence is position + lag: free slots for the
+    // tail (lag 0), filled ones for the head (lag 1)
+    claimed claim(std::atomic<size_type> &counter, const size_type wanted,
+            const size_type lag) noexcept {
+        auto position = counter.load(std::memory_order_relaxed);
+        if (wanted == 0) {
+            return {position, 0};
+        }
+        for (;;) {
+            size_type n{};
+            for (; n < wanted && n < capacity(); ++n) {
+                const auto seq = slots_[(position + n) & mask_].seq().load(
+                        std::memory_order_acquire);
+                if (seq != position + n + lag) {
+                    break;
+                }
+            }
+            if (n == 0) {
+                const auto seq = slots_[position & mask_].seq().load(
+                        std::memory_order_acquire);
+                // Behind by a lap: full for the tail, empty for the head
+                if (static_cast<std::ptrdiff_t>(seq - (position + lag)) < 0) {
+                    return {position, 0};
+                }
+                // Another thread moved the counter already
+                position = counter.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (counter.compare_exchange_weak(position, position + n,
+                        std::memory_order_relaxed)) {
+                return {position, n};
+            }
+        }
+    }
+};
+
+}  // namespace jtl
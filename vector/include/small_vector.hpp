@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2020-2023 Jeferson Santiago da Silva.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** @brief jtl::vector with inline storage for the first N elements
+ *  Only spills to the allocator when it grows past N elements, and comes
+ *  back inline on shrink_to_fit when the elements fit again
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jtl {
+
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>,
+        typename Iterator = typename std::vector<T>::iterator>
+class small_vector {
+    static_assert(N > 0, "small_vector needs room for at least one element");
+
+ public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = Iterator;
+    using const_iterator = const iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type Inline_Capacity = N;
+
+ private:
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+    alignas(T) std::byte inline_[N * sizeof(T)];
+    pointer data_{inline_data()};
+    allocator_type alloc_{};
+    size_type num_elements_{};
+    size_type size_{N};
+
+    static constexpr auto Move_Relocate =
+            std::is_nothrow_move_constructible_v<T> ||
+            !std::is_copy_constructible_v<T>;
+
+    pointer inline_data() noexcept {
+        return std::launder(reinterpret_cast<pointer>(inline_));
+    }
+
+    void destroy_range(pointer first, pointer last) {
+        for (; first != last; ++first) {
+            alloc_traits::destroy(alloc_, first);
+        }
+    }
+
+    template <typename InputIter>
+    void construct_range(pointer dest, InputIter first, InputIter last) {
+        auto cur = dest;
+        try {
+            for (; first != last; ++first, ++cur) {
+                alloc_traits::construct(alloc_, cur, *first);
+            }
+        } catch (...) {
+            destroy_range(dest, cur);
+            throw;
+        }
+    }
+
+    void relocate_range(pointer dest) {
+        if constexpr (Move_Relocate) {
+            construct_range(dest, std::make_move_iterator(data_),
+                    std::make_move_iterator(data_ + num_elements_));
+        } else {
+            construct_range(dest, data_, data_ + num_elements_);
+        }
+    }
+
+    // Moves the elements to a buffer of new_size, the inline one when they
+    // fit in it
+    void reallocate(const size_type new_size) {
+        const auto to_inline = new_size <= N;
+        if (to_inline && is_inline()) {
+            return;
+        }
+        auto nptr = to_inline ? inline_data()
+                              : std::to_address(alloc_.allocate(new_size));
+        try {
+            relocate_range(nptr);
+        } catch (...) {
+            if (!to_inline) {
+                alloc_.deallocate(nptr, new_size);
+            }
+            throw;
+        }
+        destroy_range(data_, data_ + num_elements_);
+        if (!is_inline()) {
+            alloc_.deallocate(data_, size_);
+        }
+        data_ = nptr;
+        size_ = to_inline ? N : new_size;
+    }
+
+    // Fills the buffer a constructor just reserved. No destructor runs
+    // when a constructor throws, so a heap buffer is given back here
+    template <typename InputIter>
+    void construct_owned(InputIter first, InputIter last) {
+        try {
+            construct_range(data_, first, last);
+        } catch (...) {
+            if (!is_inline()) {
+                alloc_.deallocate(data_, size_);
+            }
+            throw;
+        }
+    }
+
+    void release() {
+        clear();
+        if (!is_inline()) {
+            alloc_.deallocate(data_, size_);
+            data_ = inline_data();
+            size_ = N;
+        }
+    }
+
+    // Heap buffers change hands, inline elements have to be moved over
+    void steal(small_vector &other) {
+        if (other.is_inline()) {
+            construct_range(data_, std::make_move_iterator(other.data_),
+                    std::make_move_iterator(other.data_ + other.num_elements_));
+            num_elements_ = other.num_elements_;
+            other.clear();
+        } else {
+            data_ = std::exchange(other.data_, other.inline_data());
+            size_ = std::exchange(other.size_, N);
+            num_elements_ = std::exchange(other.num_elements_, 0);
+        }
+    }
+
+    void grow_if_full() {
+        if (num_elements_ >= capacity()) {
+            reallocate(2 * capacity());
+        }
+    }
+
+ public:
+    // Member functions
+    small_vector() noexcept(noexcept(allocator_type())) {}
+
+    explicit small_vector(const allocator_type &alloc) noexcept
+            : alloc_{alloc} {}
+
+    template <typename InputIter>
+    small_vector(InputIter first, InputIter last,
+            const allocator_type alloc = allocator_type())
+            : alloc_{alloc} {
+        reserve(static_cast<size_type>(std::distance(first, last)));
+        construct_owned(first, last);
+        num_elements_ = static_cast<size_type>(std::distance(first, last));
+    }
+
+    small_vector(std::initializer_list<T> list,
+            const allocator_type &alloc = Alloc())
+            : small_vector(list.begin(), list.end(), alloc) {}
+
+    small_vector(const small_vector &other)
+            : alloc_{alloc_traits::select_on_container_copy_construction(
+                      other.alloc_)} {
+        reserve(other.size());
+        construct_owned(other.data_, other.data_ + other.size());
+        num_elements_ = other.size();
+    }
+
+    small_vector(small_vector &&other) noexcept(
+            std::is_nothrow_move_constructible_v<T>)
+            : alloc_{std::move(other.alloc_)} {
+        steal(other);
+    }
+
+    small_vector &operator=(const small_vector &other) {
+        // Protection against self assignment
+        if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::
+                                  value) {
+                if (alloc_ != other.alloc_) {
+                    release();
+                }
+                alloc_ = other.alloc_;
+            }
+            clear();
+            reserve(other.size());
+            construct_range(data_, other.data_, other.data_ + other.size());
+            num_elements_ = other.size();
+        }
+        return *this;
+    }
+
+    small_vector &operator=(small_vector &&other) {
+        // Protection against self assignment
+        if (this != &other) {
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                                  value) {
+                alloc_ = std::move(other.alloc_);
+                steal(other);
+            } else if (alloc_ == other.alloc_ || other.is_inline()) {
+                steal(other);
+            } else {
+                // Storage can't change hands, move the elements instead
+                reserve(other.size());
+                construct_range(data_, std::make_move_iterator(other.data_),
+                        std::make_move_iterator(
+                                other.data_ + other.num_elements_));
+                num_elements_ = other.num_elements_;
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~small_vector() {
+        release();
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept {
+        return alloc_;
+    }
+
+    bool operator==(const small_vector &other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+    bool operator!=(const small_vector &other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const small_vector &other) const {
+        return std::lexicographical_compare(begin(), end(), other.begin(),
+                other.end());
+    }
+
+    bool operator>(const small_vector &other) const {
+        return other < *this;
+    }
+
+    bool operator<=(const small_vector &other) const {
+        return !(*this > other);
+    }
+
+    bool operator>=(const small_vector &other) const {
+        return !(*this < other);
+    }
+
+    auto &operator[](std::size_t index) const {
+        return data_[index];
+    }
+    auto &operator[](std::size_t index) {
+        return data_[index];
+    }
+
+    void push_back(const value_type &d) {
+        emplace_back(d);
+    }
+
+    void push_back(value_type &&d) {
+        emplace_back(std::move(d));
+    }
+
+    iterator begin() {
+        return iterator(data_);
+    }
+    iterator begin() const {
+        return iterator(data_);
+    }
+
+    iterator end() {
+        return iterator(data_ + num_elements_);
+    }
+    iterator end() const {
+        return iterator(data_ + num_elements_);
+    }
+
+    const_iterator cbegin() const {
+        return const_iterator(data_);
+    }
+
+    const_iterator cend() const {
+        return const_iterator(data_ + num_elements_);
+    }
+
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const {
+        return const_reverse_iterator(cend());
+    }
+
+    const_reverse_iterator crend() const {
+        return const_reverse_iterator(cbegin());
+    }
+
+    auto size() const {
+        return num_elements_;
+    }
+
+    auto capacity() const {
+        return size_;
+    }
+
+    // True while the elements live in the object itself
+    [[nodiscard]] bool is_inline() const noexcept {
+        return static_cast<const void *>(data_) ==
+                static_cast<const void *>(inline_);
+    }
+
+    void resize(const size_type new_size) {
+        reserve(new_size);
+        for (; num_elements_ < new_size; ++num_elements_) {
+            alloc_traits::construct(alloc_, data_ + num_elements_);
+        }
+        if (new_size < num_elements_) {
+            destroy_range(data_ + new_size, data_ + num_elements_);
+            num_elements_ = new_size;
+        }
+    }
+
+    // Only grows the raw storage, no element is constructed
+    void reserve(const size_type new_cap) {
+        if (new_cap > capacity()) {
+            reallocate(new_cap);
+        }
+    }
+
+    void shrink_to_fit() {
+        if (!is_inline() && size() < capacity()) {
+            reallocate(size());
+        }
+    }
+
+    reference emplace_back(auto &&...params) {
+        if (num_elements_ >= capacity()) {
+            // params may refer to an element about to be relocated
+            value_type value(std::forward<decltype(params)>(params)...);
+            grow_if_full();
+            alloc_traits::construct(
+                    alloc_, data_ + num_elements_, std::move(value));
+        } else {
+            alloc_traits::construct(alloc_, data_ + num_elements_,
+                    std::forward<decltype(params)>(params)...);
+        }
+        return data_[num_elements_++];
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return num_elements_ == 0;
+    }
+
+    void clear() {
+        destroy_range(data_, data_ + num_elements_);
+        num_elements_ = 0;
+    }
+};
+
+}  // namespace jtl
@@ -18,17 +18,64 @@
 
 /** @brief STL like vector
  *  Works with both custom and std allocators
+ *  Growth is driven by a policy, and trivially relocatable elements are
+ *  moved around with memcpy or by the allocator's reallocate when it has one
  */
 
 #include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace jtl {
 
+// Types whose objects can be moved to new storage with a plain memcpy, the
+// source being left for dead without running its destructor. Specialize it
+// for types holding owning pointers that are not trivially copyable
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+        is_trivially_relocatable<T>::value;
+
+// Capacity to grow to once a vector with the given capacity is full
+template <typename Growth>
+concept Growth_Policy = requires(std::size_t capacity) {
+    { Growth::next_capacity(capacity) } -> std::convertible_to<std::size_t>;
+};
+
+struct growth_2x {
+    static constexpr std::size_t next_capacity(std::size_t capacity) noexcept {
+        return std::max<std::size_t>(1, 2 * capacity);
+    }
+};
+
+// Lets freed blocks be reused by later growth steps
+struct growth_1_5x {
+    static constexpr std::size_t next_capacity(std::size_t capacity) noexcept {
+        return std::max(capacity + 1, capacity + capacity / 2);
+    }
+};
+
+// Allocators able to resize a block without going through a new one
+template <typename Alloc>
+concept Has_Reallocate = requires(Alloc alloc,
+        typename std::allocator_traits<Alloc>::pointer ptr, std::size_t n) {
+    {
+        alloc.reallocate(ptr, n, n)
+        } -> std::same_as<typename std::allocator_traits<Alloc>::pointer>;
+};
+
 template <typename T, typename Alloc = std::allocator<T>,
-        typename Iterator = typename std::vector<T>::iterator>
+        typename Iterator = typename std::vector<T>::iterator,
+        Growth_Policy Growth = growth_2x>
 class vector {
  public:
     using value_type = T;
@@ -46,26 +93,252 @@ class vector {
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
  private:
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
     pointer data_{nullptr};
     allocator_type alloc_{};
     size_type num_elements_{};
     size_type size_{};
 
+    // Same rule as std::move_if_noexcept: only move elements out of the old
+    // buffer when that cannot throw halfway through, or when there is no
+    // copy to fall back to
+    static constexpr auto Move_Relocate =
+            std::is_nothrow_move_constructible_v<T> ||
+            !std::is_copy_constructible_v<T>;
+
+    static constexpr auto Bitwise_Relocate = is_trivially_relocatable_v<T>;
+
+    static constexpr auto Trivial_Copy = std::is_trivially_copyable_v<T>;
+
+    // Sources whose elements can be block copied into the storage
+    template <typename InputIter>
+    static constexpr auto Block_Copy = Trivial_Copy &&
+            std::contiguous_iterator<InputIter> &&
+            std::is_same_v<std::iter_value_t<InputIter>, T>;
+
+    // Storage handed by the allocator is raw, only [0, size()) holds
+    // constructed elements
+    constexpr void destroy_range(pointer first, pointer last) {
+        for (; first != last; ++first) {
+            alloc_traits::destroy(alloc_, std::to_address(first));
+        }
+    }
+
+    // Builds [first, last) into the raw storage at dest, destroying what was
+    // already built if one of the constructions throws
+    template <typename InputIter, typename Sentinel>
+    constexpr void construct_range(
+            pointer dest, InputIter first, Sentinel last) {
+        if constexpr (Block_Copy<InputIter> &&
+                std::sized_sentinel_for<Sentinel, InputIter>) {
+            if (!std::is_constant_evaluated()) {
+                const auto count = static_cast<size_type>(last - first);
+                if (count > 0) {
+                    std::memcpy(static_cast<void *>(std::to_address(dest)),
+                            static_cast<const void *>(std::to_address(first)),
+                            count * sizeof(T));
+                }
+                return;
+            }
+        }
+        auto cur = dest;
+        try {
+            for (; first != last; ++first, ++cur) {
+                alloc_traits::construct(alloc_, std::to_address(cur), *first);
+            }
+        } catch (...) {
+            destroy_range(dest, cur);
+            throw;
+        }
+    }
+
+    // Fills the storage a constructor just allocated. No destructor runs
+    // when a constructor throws, so the storage is given back here
+    template <typename InputIter>
+    constexpr void construct_owned(InputIter first, InputIter last) {
+        try {
+            construct_range(data_, first, last);
+        } catch (...) {
+            deallocate_storage();
+            throw;
+        }
+    }
+
+    // Storage is only requested once the vector first grows
+    constexpr void deallocate_storage() {
+        if (data_ != nullptr) {
+            alloc_.deallocate(data_, size_);
+        }
+    }
+
+    // Relocated elements are not destroyed, their bytes now live in the new
+    // buffer
+    void relocate_bitwise(const size_type new_size) {
+        if constexpr (Has_Reallocate<allocator_type>) {
+            if (data_ != nullptr) {
+                data_ = alloc_.reallocate(data_, size_, new_size);
+                size_ = new_size;
+                return;
+            }
+        }
+        auto nptr = alloc_.allocate(new_size);
+        if (num_elements_ > 0) {
+            std::memcpy(static_cast<void *>(std::to_address(nptr)),
+                    static_cast<const void *>(std::to_address(data_)),
+                    num_elements_ * sizeof(T));
+        }
+        deallocate_storage();
+        data_ = std::move(nptr);
+        size_ = new_size;
+    }
+
     constexpr void reallocate(const size_type new_size,
             const bool shrink = false) {
         if (new_size > capacity() || shrink) {
+            if constexpr (Bitwise_Relocate) {
+                if (!std::is_constant_evaluated()) {
+                    relocate_bitwise(new_size);
+                    return;
+                }
+            }
             auto nptr = alloc_.allocate(new_size);
-            std::copy(begin(), end(), nptr);
-            alloc_.deallocate(data_, size());
+            try {
+                if constexpr (Move_Relocate) {
+                    construct_range(nptr, std::make_move_iterator(data_),
+                            std::make_move_iterator(data_ + num_elements_));
+                } else {
+                    construct_range(nptr, data_, data_ + num_elements_);
+                }
+            } catch (...) {
+                alloc_.deallocate(nptr, new_size);
+                throw;
+            }
+            destroy_range(data_, data_ + num_elements_);
+            deallocate_storage();
             data_ = std::move(nptr);
             size_ = new_size;
         }
     }
 
+    // Gives the storage back, leaving an empty vector with no capacity
+    constexpr void release() {
+        clear();
+        deallocate_storage();
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    constexpr void steal(vector &other) noexcept {
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        num_elements_ = std::exchange(other.num_elements_, 0);
+    }
+
+    // Makes room for count more elements with a single reallocation
+    constexpr void grow_for(const size_type count) {
+        const auto required = num_elements_ + count;
+        if (required > capacity()) {
+            reallocate(std::max(required,
+                    static_cast<size_type>(Growth::next_capacity(capacity()))));
+        }
+    }
+
+    constexpr size_type index_of(const_iterator pos) const {
+        return static_cast<size_type>(pos - begin());
+    }
+
+    constexpr void fill_back(const size_type count, const value_type &value) {
+        const auto first = data_ + num_elements_;
+        auto cur = first;
+        try {
+            for (; cur != first + count; ++cur) {
+                alloc_traits::construct(alloc_, std::to_address(cur), value);
+            }
+        } catch (...) {
+            destroy_range(first, cur);
+            throw;
+        }
+        num_elements_ += count;
+    }
+
+    // Moves count elements from slot src to slot dst with one memmove, both
+    // ranges may overlap
+    void move_block(
+            const size_type dst, const size_type src, const size_type count) {
+        if (count > 0) {
+            std::memmove(static_cast<void *>(std::to_address(data_ + dst)),
+                    static_cast<const void *>(std::to_address(data_ + src)),
+                    count * sizeof(T));
+        }
+    }
+
+    // Whether [first, last) is a range of this vector's own elements
+    template <typename InputIter, typename Sentinel>
+    constexpr bool aliases(InputIter first, Sentinel last) const {
+        if constexpr (std::is_same_v<std::iter_reference_t<InputIter>, T &> ||
+                std::is_same_v<std::iter_reference_t<InputIter>, const T &>) {
+            if (first == last || num_elements_ == 0) {
+                return false;
+            }
+            const std::less<const T *> less;
+            const T *element = std::addressof(*first);
+            return !less(element, std::to_address(data_)) &&
+                    less(element, std::to_address(data_ + num_elements_));
+        } else {
+            return false;
+        }
+    }
+
+    template <typename InputIter, typename Sentinel>
+    constexpr iterator insert_at(
+            const size_type idx, InputIter first, Sentinel last) {
+        const auto old_size = num_elements_;
+        if constexpr (std::forward_iterator<InputIter>) {
+            if (aliases(first, last)) {
+                // Growing or shifting would move the source under our
+                // feet, insert a copy of it instead
+                vector copy{alloc_};
+                copy.insert_at(0, first, last);
+                const auto copied = std::to_address(copy.data_);
+                return insert_at(idx, std::make_move_iterator(copied),
+                        std::make_move_iterator(copied + copy.num_elements_));
+            }
+            const auto count =
+                    static_cast<size_type>(std::ranges::distance(first, last));
+            grow_for(count);
+            if (Trivial_Copy && !std::is_constant_evaluated()) {
+                move_block(idx + count, idx, old_size - idx);
+                try {
+                    construct_range(data_ + idx, first, last);
+                } catch (...) {
+                    move_block(idx, idx + count, old_size - idx);
+                    throw;
+                }
+                num_elements_ += count;
+                return iterator(data_ + idx);
+            }
+            construct_range(data_ + num_elements_, first, last);
+            num_elements_ += count;
+        } else {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+        // The new elements were appended, rotate them into place
+        std::rotate(std::to_address(data_ + idx),
+                std::to_address(data_ + old_size),
+                std::to_address(data_ + num_elements_));
+        return iterator(data_ + idx);
+    }
+
  public:
     // Member functions
     constexpr vector() = default;
 
+    constexpr explicit vector(const allocator_type &alloc) noexcept
+            : alloc_{alloc} {}
+
     template <typename InputIter>
     constexpr vector(InputIter first, InputIter last,
             const allocator_type alloc = allocator_type())
@@ -74,16 +347,24 @@ class vector {
                       static_cast<std::size_t>(std::distance(first, last))},
               size_{static_cast<std::size_t>(std::distance(first, last))} {
         data_ = alloc_.allocate(size_);
-        std::copy(first, last, &data_[0]);
+        construct_owned(first, last);
     }
 
     constexpr vector(const vector &other)
-            : num_elements_{other.size()},
+            : alloc_{alloc_traits::select_on_container_copy_construction(
+                      other.alloc_)},
+              num_elements_{other.size()},
               size_{other.capacity()} {
         data_ = alloc_.allocate(size_);
-        std::copy(other.begin(), other.end(), data_);
+        construct_owned(other.begin(), other.end());
     };
 
+    constexpr vector(vector &&other) noexcept
+            : data_{std::exchange(other.data_, nullptr)},
+              alloc_{std::move(other.alloc_)},
+              num_elements_{std::exchange(other.num_elements_, 0)},
+              size_{std::exchange(other.size_, 0)} {}
+
     constexpr vector(std::initializer_list<T> list,
             const allocator_type &alloc = Alloc())
             : vector(list.begin(), list.end(), alloc) {}
@@ -91,21 +372,61 @@ class vector {
     constexpr vector &operator=(const vector &other) {
         // Protection against self assignment
         if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::
+                                  value) {
+                // Old storage must go back to the allocator that handed it
+                if (alloc_ != other.alloc_) {
+                    release();
+                }
+                alloc_ = other.alloc_;
+            }
             auto new_elems = alloc_.allocate(other.capacity());
-            std::copy(other.begin(), other.end(), new_elems);
-            alloc_.deallocate(data_, size_);
+            try {
+                construct_range(new_elems, other.begin(), other.end());
+            } catch (...) {
+                alloc_.deallocate(new_elems, other.capacity());
+                throw;
+            }
+            clear();
+            deallocate_storage();
             data_ = std::move(new_elems);
             size_ = other.capacity();
             num_elements_ = other.size();
         }
         return *this;
     }
-    // constexpr vector& operator=(vector&&) = default;
+
+    constexpr vector &operator=(vector &&other) noexcept(
+            alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_traits::is_always_equal::value) {
+        // Protection against self assignment
+        if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                                  value) {
+                release();
+                alloc_ = std::move(other.alloc_);
+                steal(other);
+            } else if (alloc_ == other.alloc_) {
+                release();
+                steal(other);
+            } else {
+                // Storage can't change hands, move the elements instead
+                *this = vector(std::make_move_iterator(other.begin()),
+                        std::make_move_iterator(other.end()), alloc_);
+                other.clear();
+            }
+        }
+        return *this;
+    }
 
     constexpr ~vector() {
-        alloc_.deallocate(data_, size_);
+        release();
     };
 
+    [[nodiscard]] constexpr allocator_type get_allocator() const noexcept {
+        return alloc_;
+    }
+
     constexpr bool operator==(const vector &other) const {
         if ((size() == other.size()) && (capacity() == other.capacity())) {
             return std::equal(begin(), end(), other.begin());
@@ -145,12 +466,11 @@ class vector {
     }
 
     constexpr void push_back(const value_type &d) {
-        auto bkp_num_elements = num_elements_;
-        if (num_elements_ >= capacity()) {
-            resize(2 * size());
-        }
-        num_elements_ = bkp_num_elements;
-        data_[num_elements_++] = d;
+        emplace_back(d);
+    }
+
+    constexpr void push_back(value_type &&d) {
+        emplace_back(std::move(d));
     }
 
     constexpr iterator begin() {
@@ -219,14 +539,33 @@ class vector {
 
     constexpr void resize(const size_type new_size) {
         reallocate(new_size);
-        num_elements_ = new_size;
+        for (; num_elements_ < new_size; ++num_elements_) {
+            alloc_traits::construct(
+                    alloc_, std::to_address(data_ + num_elements_));
+        }
+        if (new_size < num_elements_) {
+            destroy_range(data_ + new_size, data_ + num_elements_);
+            num_elements_ = new_size;
+        }
+    }
+
+    constexpr void resize(const size_type new_size, const value_type &value) {
+        if (new_size > capacity()) {
+            // value may live in the buffer about to be released
+            const auto copy = value;
+            reallocate(new_size);
+            fill_back(new_size - num_elements_, copy);
+        } else if (new_size > num_elements_) {
+            fill_back(new_size - num_elements_, value);
+        } else {
+            destroy_range(data_ + new_size, data_ + num_elements_);
+            num_elements_ = new_size;
+        }
     }
 
+    // Only grows the raw storage, no element is constructed
     constexpr void reserve(const size_type new_cap) {
         reallocate(new_cap);
-        if (new_cap < size()) {
-            num_elements_ = new_cap;
-        }
     }
 
     constexpr void shrink_to_fit() {
@@ -234,13 +573,89 @@ class vector {
     }
 
     constexpr reference emplace_back(auto &&...params) {
-        auto bkp_num_elements = num_elements_;
-        if (num_elements_ >= capacity()) {
-            resize(2 * size());
+        if (num_elements_ == capacity()) {
+            // params may refer to an element of the buffer about to be
+            // released, build the new element before growing
+            value_type value(std::forward<decltype(params)>(params)...);
+            grow_for(1);
+            alloc_traits::construct(alloc_,
+                    std::to_address(data_ + num_elements_), std::move(value));
+        } else {
+            alloc_traits::construct(alloc_,
+                    std::to_address(data_ + num_elements_),
+                    std::forward<decltype(params)>(params)...);
         }
-        num_elements_ = bkp_num_elements;
-        data_[num_elements_++] = T{std::forward<decltype(params)>(params)...};
-        return data_[bkp_num_elements];
+        return data_[num_elements_++];
+    }
+
+    // Range operations reserve once for the whole range, trivially copyable
+    // elements are shifted and copied as blocks
+    template <std::input_iterator InputIter>
+    constexpr iterator insert(
+            const_iterator pos, InputIter first, InputIter last) {
+        return insert_at(index_of(pos), first, last);
+    }
+
+    constexpr iterator insert(
+            const_iterator pos, std::initializer_list<T> list) {
+        return insert_at(index_of(pos), list.begin(), list.end());
+    }
+
+    template <std::ranges::input_range Range>
+    constexpr void append_range(Range &&range) {
+        insert_at(num_elements_, std::ranges::begin(range),
+                std::ranges::end(range));
+    }
+
+    template <std::input_iterator InputIter>
+    constexpr void assign(InputIter first, InputIter last) {
+        if constexpr (std::forward_iterator<InputIter>) {
+            if (aliases(first, last)) {
+                // clear would destroy the source
+                vector copy{alloc_};
+                copy.insert_at(0, first, last);
+                clear();
+                const auto copied = std::to_address(copy.data_);
+                insert_at(0, std::make_move_iterator(copied),
+                        std::make_move_iterator(copied + copy.num_elements_));
+                return;
+            }
+        }
+        clear();
+        insert_at(0, first, last);
+    }
+
+    constexpr void assign(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
+    }
+
+    constexpr void assign(const size_type count, const value_type &value) {
+        std::fill_n(std::to_address(data_), std::min(count, num_elements_),
+                value);
+        resize(count, value);
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) {
+        const auto idx = index_of(first);
+        const auto count = static_cast<size_type>(last - first);
+        if (count > 0) {
+            if (Trivial_Copy && !std::is_constant_evaluated()) {
+                move_block(idx, idx + count, num_elements_ - idx - count);
+            } else {
+                std::move(std::to_address(data_ + idx + count),
+                        std::to_address(data_ + num_elements_),
+                        std::to_address(data_ + idx));
+                destroy_range(data_ + num_elements_ - count,
+                        data_ + num_elements_);
+            }
+            num_elements_ -= count;
+        }
+        return iterator(data_ + idx);
+    }
+
+    constexpr iterator erase(const_iterator pos) {
+        const auto idx = index_of(pos);
+        return erase(pos, iterator(data_ + idx + 1));
     }
 
     [[nodiscard]] constexpr decltype(auto) empty() const noexcept {
@@ -248,8 +663,19 @@ class vector {
     }
 
     constexpr void clear() {
+        destroy_range(data_, data_ + num_elements_);
         num_elements_ = 0;
     }
 };
 
+// Removes the elements matching pred in one pass, returns how many went away
+template <typename T, typename Alloc, typename Iterator, typename Growth,
+        typename Pred>
+constexpr auto erase_if(vector<T, Alloc, Iterator, Growth> &vec, Pred pred) {
+    const auto first = std::remove_if(vec.begin(), vec.end(), pred);
+    const auto removed = static_cast<std::size_t>(vec.end() - first);
+    vec.erase(first, vec.end());
+    return removed;
+}
+
 }  // namespace jtl
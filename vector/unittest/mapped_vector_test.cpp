@@ -0,0 +1,125 @@
+#include "mapped_vector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "iterator.hpp"
+
+struct Record {
+    std::uint32_t key;
+    std::uint16_t value;
+};
+
+template <typename T>
+using jtl_mapped_vector_t = jtl::mapped_vector<T, jtl::RandomAccessIterator<T>>;
+
+struct MappedVectorTest : testing::Test {
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+            ("jtl_mapped_vector_" + std::to_string(::getpid()) + "_" +
+                    testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name());
+
+    ~MappedVectorTest() override {
+        std::filesystem::remove(path);
+    }
+};
+
+TEST_F(MappedVectorTest, CreateEmpty) {
+    jtl_mapped_vector_t<std::uint64_t> vec{path};
+    EXPECT_TRUE(vec.empty() && vec.capacity() == 0 &&
+            std::filesystem::file_size(path) == sizeof(decltype(vec)::header));
+}
+
+TEST_F(MappedVectorTest, Reopen) {
+    {
+        jtl_mapped_vector_t<Record> vec{path, 42};
+        for (std::uint32_t i = 0; i < 1000; ++i) {
+            vec.push_back(Record{i, static_cast<std::uint16_t>(i * 2)});
+        }
+        vec.emplace_back(7u, std::uint16_t{8});
+        vec.sync();
+    }
+    jtl_mapped_vector_t<Record> vec{path, 42};
+    EXPECT_TRUE(vec.size() == 1001 && vec.capacity() == 1024 &&
+            vec[999].key == 999 && vec[999].value == 1998 &&
+            vec[1000].key == 7 && vec.layout() == 42);
+}
+
+TEST_F(MappedVectorTest, PushBackSelfAlias) {
+    jtl_mapped_vector_t<std::uint64_t> vec{path};
+    vec.push_back(42);
+    for (auto i = 0; i < 16; ++i) {
+        vec.push_back(vec[vec.size() - 1]);
+    }
+    EXPECT_TRUE(vec.size() == 17 &&
+            std::all_of(vec.begin(), vec.end(),
+                    [](const auto el) { return el == 42; }));
+}
+
+TEST_F(MappedVectorTest, ResizeShrink) {
+    jtl_mapped_vector_t<std::uint32_t> vec{path};
+    vec.append_range(std::array<std::uint32_t, 4>{1, 2, 3, 4});
+    vec.resize(2);
+    vec.resize(3);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.size() == 3 && vec.capacity() == 3 && vec[1] == 2 &&
+            vec[2] == 0);
+    EXPECT_EQ(std::filesystem::file_size(path),
+            sizeof(decltype(vec)::header) + 3 * sizeof(std::uint32_t));
+}
+
+TEST_F(MappedVectorTest, LayoutMismatch) {
+    {
+        jtl_mapped_vector_t<std::uint32_t> vec{path, 1};
+        vec.push_back(1);
+    }
+    EXPECT_THROW(jtl_mapped_vector_t<std::uint32_t>(path, 2),
+            std::runtime_error);
+    EXPECT_THROW(jtl_mapped_vector_t<std::uint64_t>(path, 1),
+            std::runtime_error);
+}
+
+TEST_F(MappedVectorTest, ReadOnly) {
+    // Missing files are not created
+    EXPECT_THROW(jtl_mapped_vector_t<std::uint32_t>(
+                         path, 0, jtl::map_mode::read_only),
+            std::system_error);
+    EXPECT_FALSE(std::filesystem::exists(path));
+    {
+        jtl_mapped_vector_t<std::uint32_t> vec{path, 3};
+        vec.append_range(std::array<std::uint32_t, 3>{1, 2, 3});
+    }
+    jtl_mapped_vector_t<std::uint32_t> vec{path, 3, jtl::map_mode::read_only};
+    jtl_mapped_vector_t<std::uint32_t> vec2{path, 3, jtl::map_mode::read_only};
+    EXPECT_TRUE(vec.read_only() && vec.size() == 3 && vec[2] == 3 &&
+            vec == vec2);
+    EXPECT_THROW(vec.push_back(4), std::logic_error);
+    EXPECT_THROW(vec.resize(1), std::logic_error);
+    EXPECT_THROW(vec.clear(), std::logic_error);
+    EXPECT_EQ(vec.size(), 3u);
+    EXPECT_THROW(jtl_mapped_vector_t<std::uint32_t>(
+                         path, 4, jtl::map_mode::read_only),
+            std::runtime_error);
+}
+
+TEST_F(MappedVectorTest, Move) {
+    jtl_mapped_vector_t<std::uint32_t> vec{path};
+    vec.push_back(5);
+    auto vec2{std::move(vec)};
+    EXPECT_TRUE(vec2.size() == 1 && *vec2.begin() == 5);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+#include "ring_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tracking_allocator.hpp"
+
+TEST(SpscRingTest, PowerOfTwoCapacity) {
+    EXPECT_EQ(jtl::spsc_ring<int>{5}.capacity(), 8u);
+    EXPECT_EQ(jtl::spsc_ring<int>{8}.capacity(), 8u);
+    EXPECT_EQ(jtl::spsc_ring<int>{0}.capacity(), 1u);
+    EXPECT_EQ(jtl::mpmc_ring<int>{100}.capacity(), 128u);
+}
+
+TEST(SpscRingTest, FullAndEmpty) {
+    jtl::spsc_ring<std::string> ring{4};
+    std::string value;
+    EXPECT_FALSE(ring.try_pop(value));
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(std::to_string(i)));
+    }
+    EXPECT_FALSE(ring.try_push("full"));
+    EXPECT_EQ(ring.size(), 4u);
+    // Wraps around several times
+    for (auto i = 4; i < 40; ++i) {
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, std::to_string(i - 4));
+        ASSERT_TRUE(ring.try_emplace(std::to_string(i)));
+    }
+    // Left in the ring, destroyed with it
+}
+
+TEST(SpscRingTest, Batches) {
+    jtl::spsc_ring<int> ring{8};
+    const std::array<int, 10> in{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(ring.try_push_n(in.begin(), in.size()), 8u);
+    std::vector<int> out;
+    EXPECT_EQ(ring.try_pop_n(std::back_inserter(out), 3), 3u);
+    EXPECT_EQ(ring.try_push_n(in.begin() + 8, 2), 2u);
+    EXPECT_EQ(ring.try_pop_n(std::back_inserter(out), 100), 7u);
+    EXPECT_EQ(out, std::vector<int>(in.begin(), in.end()));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, Allocator) {
+    jtl::tracking_allocator<std::uint64_t> alloc;
+    {
+        jtl::spsc_ring<std::uint64_t, jtl::tracking_allocator<std::uint64_t>>
+                ring{16, alloc};
+        EXPECT_EQ(alloc.stats().live_bytes, 16 * sizeof(std::uint64_t));
+        for (std::uint64_t i = 0; i < 100; ++i) {
+            std::uint64_t value{};
+            EXPECT_TRUE(ring.try_push(i) && ring.try_pop(value) && value == i);
+        }
+        EXPECT_EQ(alloc.stats().allocations, 1u);
+    }
+    EXPECT_EQ(alloc.stats().live_bytes, 0u);
+}
+
+TEST(SpscRingTest, Threads) {
+    constexpr std::uint64_t Count = 100'000;
+    jtl::spsc_ring<std::uint64_t> ring{64};
+    std::thread producer{[&] {
+        std::array<std::uint64_t, 16> batch{};
+        for (std::uint64_t i = 0; i < Count;) {
+            for (std::size_t j = 0; j < batch.size(); ++j) {
+                batch[j] = i + j;
+            }
+            const auto wanted =
+                    std::min<std::uint64_t>(batch.size(), Count - i);
+            const auto n = ring.try_push_n(batch.begin(), wanted);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            i += n;
+        }
+    }};
+    std::uint64_t expected{};
+    std::array<std::uint64_t, 16> batch{};
+    while (expected < Count) {
+        const auto n = ring.try_pop_n(batch.begin(), batch.size());
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            ASSERT_EQ(batch[j], expected++);
+        }
+    }
+    producer.join();
+}
+
+TEST(MpmcRingTest, FullAndEmpty) {
+    jtl::mpmc_ring<std::string> ring{4};
+    std::string value;
+    EXPECT_FALSE(ring.try_pop(value));
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_emplace(std::to_string(i)));
+    }
+    EXPECT_FALSE(ring.try_push("full"));
+    for (auto i = 4; i < 40; ++i) {
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, std::to_string(i - 4));
+        ASSERT_TRUE(ring.try_push(std::to_string(i)));
+    }
+    EXPECT_EQ(ring.size(), 4u);
+}
+
+TEST(MpmcRingTest, Batches) {
+    jtl::mpmc_ring<int> ring{8};
+    const std::array<int, 10> in{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(ring.try_push_n(in.begin(), in.size()), 8u);
+    std::array<int, 10> out{};
+    EXPECT_EQ(ring.try_pop_n(out.begin(), 3), 3u);
+    EXPECT_EQ(ring.try_push_n(in.begin() + 8, 2), 2u);
+    EXPECT_EQ(ring.try_pop_n(out.begin() + 3, 100), 7u);
+    EXPECT_EQ(out, in);
+    EXPECT_EQ(ring.try_pop_n(out.begin(), 1), 0u);
+}
+
+TEST(MpmcRingTest, Threads) {
+    constexpr auto Threads = 3;
+    constexpr std::uint64_t Per_Thread = 20'000;
+    jtl::mpmc_ring<std::uint64_t> ring{128};
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+    std::array<std::uint64_t, Threads> sums{};
+    std::atomic<std::uint64_t> received{0};
+    for (auto t = 0; t < Threads; ++t) {
+        producers.emplace_back([&ring, t] {
+            for (std::uint64_t i = 0; i < Per_Thread;) {
+                const auto value = i * Threads + t;
+                if (ring.try_push(value)) {
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        consumers.emplace_back([&, t] {
+            std::array<std::uint64_t, 8> batch{};
+            while (received.load() < Threads * Per_Thread) {
+                const auto n = ring.try_pop_n(batch.begin(), batch.size());
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t j = 0; j < n; ++j) {
+                    sums[t] += batch[j];
+                }
+                received += n;
+            }
+        });
+    }
+    for (auto &thread : producers) {
+        thread.join();
+    }
+    for (auto &thread : consumers) {
+        thread.join();
+    }
+    // Every value in [0, Threads * Per_Thread) went through exactly once
+    const auto total = Threads * Per_Thread;
+    EXPECT_EQ(sums[0] + sums[1] + sums[2], total * (total - 1) / 2);
+    EXPECT_TRUE(ring.empty());
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
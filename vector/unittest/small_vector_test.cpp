@@ -0,0 +1,135 @@
+#include "small_vector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "allocator.hpp"
+#include "arena_allocator.hpp"
+#include "iterator.hpp"
+
+using namespace std::literals;
+
+template <typename T, std::size_t N>
+using jtl_small_vector_t = jtl::small_vector<T, N, jtl::allocator<T>,
+        jtl::RandomAccessIterator<T>>;
+
+TEST(SmallVectorTest, StaysInline) {
+    jtl_small_vector_t<int, 8> vec;
+    for (auto i = 0; i < 8; ++i) {
+        vec.push_back(i);
+    }
+    EXPECT_TRUE(vec.is_inline() && vec.size() == 8 && vec.capacity() == 8);
+    EXPECT_TRUE(static_cast<const void *>(&vec[0]) >=
+                    static_cast<const void *>(&vec) &&
+            static_cast<const void *>(&vec[7]) <
+                    static_cast<const void *>(&vec + 1));
+}
+
+TEST(SmallVectorTest, SpillAndShrink) {
+    jtl_small_vector_t<std::string, 4> vec;
+    for (auto i = 0; i < 9; ++i) {
+        vec.emplace_back(std::to_string(i));
+    }
+    EXPECT_TRUE(!vec.is_inline() && vec.size() == 9 && vec.capacity() == 16);
+
+    vec.resize(3);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.is_inline() && vec.capacity() == 4 && vec[2] == "2"s);
+}
+
+TEST(SmallVectorTest, PushBackSelfAlias) {
+    jtl_small_vector_t<std::string, 2> vec{"first long enough for the heap"s};
+    // Spills out of the inline buffer, then grows the heap one
+    for (auto i = 0; i < 5; ++i) {
+        vec.push_back(vec[0]);
+        vec.emplace_back(vec[vec.size() - 1]);
+    }
+    EXPECT_TRUE(vec.size() == 11 && !vec.is_inline());
+    for (const auto &s : vec) {
+        EXPECT_EQ(s, "first long enough for the heap"s);
+    }
+}
+
+TEST(SmallVectorTest, CopyMove) {
+    jtl_small_vector_t<std::string, 2> small{"a"s, "b"s};
+    jtl_small_vector_t<std::string, 2> big{"a"s, "b"s, "c"s};
+    const auto data = &big[0];
+
+    auto small2{small};
+    auto small3{std::move(small)};
+    EXPECT_TRUE(small2 == small3 && small3.is_inline() && small.empty());
+
+    auto big2{std::move(big)};
+    EXPECT_TRUE(&big2[0] == data && big.is_inline() && big.capacity() == 2);
+
+    small2 = big2;
+    big = std::move(small3);
+    EXPECT_TRUE(small2 == big2 && big.size() == 2 && big[1] == "b"s);
+}
+
+struct ThrowingCopy {
+    static inline int countdown{-1};
+
+    std::string value;
+
+    explicit ThrowingCopy(std::string v) : value{std::move(v)} {}
+    ThrowingCopy(const ThrowingCopy &other) : value{other.value} {
+        if (countdown-- == 0) {
+            throw std::runtime_error("copy");
+        }
+    }
+    ThrowingCopy(ThrowingCopy &&) noexcept = default;
+    ThrowingCopy &operator=(const ThrowingCopy &) = default;
+    ThrowingCopy &operator=(ThrowingCopy &&) noexcept = default;
+    ~ThrowingCopy() = default;
+};
+
+TEST(SmallVectorTest, CopyThrowsNoLeak) {
+    using vector_t = jtl_small_vector_t<ThrowingCopy, 2>;
+    vector_t vec;
+    for (auto i = 0; i < 5; ++i) {
+        vec.emplace_back(std::to_string(i) + " long enough for the heap"s);
+    }
+    // The leak sanitizer catches a spilled buffer left behind
+    ThrowingCopy::countdown = 2;
+    EXPECT_THROW(vector_t{vec}, std::runtime_error);
+    ThrowingCopy::countdown = 2;
+    EXPECT_THROW((vector_t{vec.begin(), vec.end()}), std::runtime_error);
+    ThrowingCopy::countdown = -1;
+    EXPECT_EQ(vector_t{vec}.size(), 5u);
+}
+
+TEST(SmallVectorTest, Compare) {
+    jtl_small_vector_t<int, 4> vec{1, 2, 3};
+    jtl_small_vector_t<int, 4> vec2{1, 2, 4};
+    EXPECT_TRUE(vec < vec2 && vec2 > vec && vec <= vec && vec != vec2);
+}
+
+TEST(SmallVectorTest, Iterators) {
+    jtl_small_vector_t<int, 4> vec{1, 2, 3, 4, 5};
+    auto sum = 0;
+    for (const auto &el : vec) {
+        sum += el;
+    }
+    EXPECT_TRUE(sum == 15 && *vec.rbegin() == 5);
+}
+
+TEST(SmallVectorTest, ArenaSpill) {
+    alignas(std::max_align_t) std::array<std::byte, 256> buffer{};
+    jtl::arena arena{buffer.data(), buffer.size()};
+    jtl::small_vector<int, 2, jtl::arena_allocator<int>> vec{
+            jtl::arena_allocator<int>{arena}};
+    for (auto i = 0; i < 16; ++i) {
+        vec.push_back(i);
+    }
+    EXPECT_TRUE(!vec.is_inline() && vec[15] == 15 && arena.chunks() == 0);
+}
+
+int main(int argc, char *argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,11 +2,17 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "allocator.hpp"
+#include "arena_allocator.hpp"
 #include "common.hpp"
 #include "iterator.hpp"
+#include "tracking_allocator.hpp"
 
 using namespace std::literals;
 
@@ -16,6 +22,74 @@ struct S {
     T j;
 };
 
+// Counts the copies and moves made of it
+struct Tracked {
+    static inline std::size_t copies{};
+    static inline std::size_t moves{};
+
+    std::string value;
+
+    Tracked() = default;
+    explicit Tracked(std::string v) : value{std::move(v)} {}
+    Tracked(const Tracked &other) : value{other.value} {
+        ++copies;
+    }
+    Tracked(Tracked &&other) noexcept : value{std::move(other.value)} {
+        ++moves;
+    }
+    Tracked &operator=(const Tracked &other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    Tracked &operator=(Tracked &&other) noexcept {
+        value = std::move(other.value);
+        ++moves;
+        return *this;
+    }
+    ~Tracked() {
+        ++destructions;
+    }
+
+    static inline std::size_t destructions{};
+
+    static void reset() {
+        copies = moves = destructions = 0;
+    }
+};
+
+// Copy construction throws once the countdown reaches zero
+struct ThrowingCopy {
+    static inline int countdown{-1};
+
+    std::string value;
+
+    explicit ThrowingCopy(std::string v) : value{std::move(v)} {}
+    ThrowingCopy(const ThrowingCopy &other) : value{other.value} {
+        if (countdown-- == 0) {
+            throw std::runtime_error("copy");
+        }
+    }
+    ThrowingCopy(ThrowingCopy &&) noexcept = default;
+    ThrowingCopy &operator=(const ThrowingCopy &) = default;
+    ThrowingCopy &operator=(ThrowingCopy &&) noexcept = default;
+    ~ThrowingCopy() = default;
+};
+
+// Not default constructible, can only live in a vector whose storage is raw
+struct NoDefault {
+    int value;
+    explicit NoDefault(int v) : value{v} {}
+};
+
+// Owns heap memory, yet nothing in it depends on its own address
+struct Relocatable {
+    std::unique_ptr<int> value;
+};
+
+template <>
+struct jtl::is_trivially_relocatable<Relocatable> : std::true_type {};
+
 template <typename T>
 using jtl_vector_t =
         jtl::vector<T, jtl::allocator<T>, jtl::RandomAccessIterator<T>>;
@@ -123,6 +197,274 @@ TEST_F(VectorTest, SizeResizeShrinkCapacity) {
     EXPECT_TRUE(res);
 }
 
+TEST_F(VectorTest, PushBackEmpty) {
+    jtl_vector_t<int> vec;
+    vec.push_back(1);
+    vec.emplace_back(2);
+    EXPECT_TRUE(vec.size() == 2 && vec[0] == 1 && vec[1] == 2);
+}
+
+TEST_F(VectorTest, PushBackSelfAlias) {
+    jtl_vector_t<std::string> vec{"first long enough for the heap"s};
+    // Both go through a full vector several times
+    for (auto i = 0; i < 10; ++i) {
+        vec.push_back(vec[0]);
+        vec.emplace_back(vec[vec.size() - 1]);
+    }
+    EXPECT_EQ(vec.size(), 21u);
+    EXPECT_TRUE(std::all_of(vec.begin(), vec.end(), [](const auto &s) {
+        return s == "first long enough for the heap"s;
+    }));
+}
+
+TEST_F(VectorTest, CopyThrowsNoLeak) {
+    jtl_vector_t<ThrowingCopy> vec;
+    for (auto i = 0; i < 4; ++i) {
+        vec.emplace_back(std::to_string(i) + " long enough for the heap"s);
+    }
+    // The leak sanitizer catches storage left behind
+    ThrowingCopy::countdown = 2;
+    EXPECT_THROW(jtl_vector_t<ThrowingCopy>{vec}, std::runtime_error);
+    ThrowingCopy::countdown = 2;
+    EXPECT_THROW((jtl_vector_t<ThrowingCopy>{vec.begin(), vec.end()}),
+            std::runtime_error);
+    jtl_vector_t<ThrowingCopy> vec2;
+    vec2.emplace_back("kept"s);
+    ThrowingCopy::countdown = 2;
+    EXPECT_THROW(vec2 = vec, std::runtime_error);
+    ThrowingCopy::countdown = -1;
+    EXPECT_TRUE(vec2.size() == 1 && vec2[0].value == "kept"s);
+}
+
+TEST_F(VectorTest, MoveConstructAssign) {
+    jtl_vector_t<std::string> vec{"a"s, "b"s, "c"s};
+    const auto data = &vec[0];
+
+    auto vec2{std::move(vec)};
+    EXPECT_TRUE(vec2.size() == 3 && &vec2[0] == data);
+    EXPECT_TRUE(vec.empty() && vec.capacity() == 0);
+
+    jtl_vector_t<std::string> vec3{"d"s};
+    vec3 = std::move(vec2);
+    EXPECT_TRUE(vec3.size() == 3 && &vec3[0] == data && vec3[2] == "c"s);
+    EXPECT_TRUE(vec2.empty() && vec2.capacity() == 0);
+}
+
+TEST_F(VectorTest, GrowthDoesNotCopy) {
+    Tracked::reset();
+    jtl_vector_t<Tracked> vec;
+    for (auto i = 0; i < 100; ++i) {
+        vec.push_back(Tracked{std::to_string(i)});
+        vec.emplace_back(std::to_string(i));
+    }
+    auto vec2{std::move(vec)};
+    jtl_vector_t<Tracked> vec3;
+    vec3 = std::move(vec2);
+
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_TRUE(vec3.size() == 200 && vec3[198].value == "99"s);
+}
+
+TEST_F(VectorTest, ReserveDoesNotConstruct) {
+    jtl_vector_t<NoDefault> vec;
+    vec.reserve(1 << 20);
+    vec.emplace_back(42);
+    EXPECT_TRUE(vec.size() == 1 && vec.capacity() == (1 << 20) &&
+            vec[0].value == 42);
+}
+
+TEST_F(VectorTest, ElementLifetimes) {
+    Tracked::reset();
+    {
+        jtl_vector_t<Tracked> vec;
+        vec.reserve(16);
+        EXPECT_EQ(Tracked::destructions, 0);
+        vec.resize(8);
+        vec.resize(4);
+        EXPECT_EQ(Tracked::destructions, 4);
+        vec.clear();
+        EXPECT_EQ(Tracked::destructions, 8);
+        vec.emplace_back("a"s);
+    }
+    EXPECT_EQ(Tracked::destructions, 9);
+}
+
+TEST_F(VectorTest, StdAllocatorStrings) {
+    jtl::vector<std::string> vec;
+    for (auto i = 0; i < 64; ++i) {
+        vec.push_back(std::string(32, 'a' + i % 26));
+    }
+    vec.resize(10);
+    vec.shrink_to_fit();
+    auto vec2 = vec;
+    EXPECT_TRUE(vec2.size() == 10 && vec2[9] == std::string(32, 'j'));
+}
+
+TEST_F(VectorTest, ArenaAllocator) {
+    using arena_vector_t = jtl::vector<std::string,
+            jtl::arena_allocator<std::string>,
+            jtl::RandomAccessIterator<std::string>>;
+    alignas(std::max_align_t) std::array<std::byte, 4096> buffer{};
+    jtl::arena arena{buffer.data(), buffer.size()};
+    jtl::arena arena2;
+
+    arena_vector_t vec{jtl::arena_allocator<std::string>{arena}};
+    for (auto i = 0; i < 16; ++i) {
+        vec.emplace_back(std::to_string(i));
+    }
+
+    // Copies stay in the source arena, assignments bring the allocator along
+    const auto copy{vec};
+    arena_vector_t vec2{{"a"s, "b"s}, jtl::arena_allocator<std::string>{arena2}};
+    vec2 = vec;
+    arena_vector_t vec3{jtl::arena_allocator<std::string>{arena2}};
+    vec3 = std::move(vec);
+
+    EXPECT_TRUE(copy.get_allocator().resource() == &arena &&
+            vec2.get_allocator().resource() == &arena &&
+            vec3.get_allocator().resource() == &arena);
+    EXPECT_TRUE(compare_vecs(copy, vec2) && vec3[15] == "15"s);
+    EXPECT_TRUE(arena.chunks() == 0 && arena2.chunks() == 1);
+}
+
+TEST_F(VectorTest, GrowthPolicy) {
+    jtl::vector<int, jtl::allocator<int>, jtl::RandomAccessIterator<int>,
+            jtl::growth_1_5x>
+            vec;
+    std::vector<std::size_t> capacities;
+    for (auto i = 0; i < 10; ++i) {
+        vec.push_back(i);
+        capacities.push_back(vec.capacity());
+    }
+    EXPECT_EQ(capacities,
+            (std::vector<std::size_t>{1, 2, 3, 4, 6, 6, 9, 9, 9, 13}));
+    EXPECT_TRUE(vec[0] == 0 && vec[9] == 9);
+}
+
+TEST_F(VectorTest, TriviallyRelocatable) {
+    static_assert(jtl::is_trivially_relocatable_v<S<int>> &&
+            !jtl::is_trivially_relocatable_v<std::string>);
+
+    jtl_vector_t<Relocatable> vec;
+    jtl::vector<Relocatable> vec2;
+    for (auto i = 0; i < 100; ++i) {
+        vec.push_back(Relocatable{std::make_unique<int>(i)});
+        vec2.push_back(Relocatable{std::make_unique<int>(i)});
+    }
+    vec.resize(50);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.capacity() == 50 && *vec[49].value == 49 &&
+            *vec2[99].value == 99);
+}
+
+TEST_F(VectorTest, InsertRange) {
+    jtl_vector_t<int> vec{1, 2, 6};
+    const std::array arr{3, 4, 5};
+    auto it = vec.insert(vec.begin() + 2, arr.begin(), arr.end());
+    EXPECT_TRUE(*it == 3 && vec.capacity() == 6 &&
+            std::equal(vec.begin(), vec.end(),
+                    std::array{1, 2, 3, 4, 5, 6}.begin()));
+
+    jtl_vector_t<std::string> vec2{"a"s, "d"s};
+    vec2.insert(vec2.begin() + 1, {"b"s, "c"s});
+    vec2.insert(vec2.end(), {"e"s});
+    EXPECT_TRUE(vec2.size() == 5 && vec2[1] == "b"s && vec2[2] == "c"s &&
+            vec2[4] == "e"s);
+}
+
+TEST_F(VectorTest, InsertSelfRange) {
+    // Full vectors, the source would be freed by the growth
+    jtl::vector<int> vec{1, 2, 3};
+    vec.insert(vec.begin(), vec.begin(), vec.end());
+    EXPECT_TRUE(std::equal(vec.begin(), vec.end(),
+            std::array{1, 2, 3, 1, 2, 3}.begin()));
+    jtl::vector<std::string> vec2{"a long string out of the SSO"s, "b"s};
+    vec2.append_range(vec2);
+    EXPECT_TRUE(vec2.size() == 4 && vec2[2] == vec2[0] && vec2[3] == "b"s);
+
+    // Enough room, the source would be shifted before it is copied
+    jtl::vector<int> vec3{1, 2, 3, 4};
+    vec3.reserve(16);
+    vec3.insert(vec3.begin() + 1, vec3.begin() + 2, vec3.end());
+    EXPECT_TRUE(vec3.capacity() == 16 &&
+            std::equal(vec3.begin(), vec3.end(),
+                    std::array{1, 3, 4, 2, 3, 4}.begin()));
+
+    vec2.assign(vec2.begin() + 1, vec2.begin() + 3);
+    EXPECT_TRUE(vec2.size() == 2 && vec2[0] == "b"s &&
+            vec2[1] == "a long string out of the SSO"s);
+}
+
+TEST_F(VectorTest, AppendRangeAssign) {
+    jtl_vector_t<int> vec{1, 2};
+    std::vector batch(1000, 7);
+    vec.append_range(batch);
+    EXPECT_TRUE(vec.size() == 1002 && vec.capacity() == 1002 &&
+            vec[1001] == 7);
+
+    vec.assign({4, 5, 6});
+    EXPECT_TRUE(vec.size() == 3 && vec[0] == 4 && vec[2] == 6);
+
+    jtl_vector_t<std::string> vec2{"a"s, "b"s, "c"s};
+    vec2.assign(5, vec2[1]);
+    EXPECT_TRUE(vec2.size() == 5 && vec2[0] == "b"s && vec2[4] == "b"s);
+    vec2.assign(2, "z"s);
+    EXPECT_TRUE(vec2.size() == 2 && vec2[1] == "z"s);
+}
+
+TEST_F(VectorTest, ResizeValue) {
+    jtl_vector_t<std::string> vec{"a"s};
+    vec.resize(4, vec[0]);
+    EXPECT_TRUE(vec.size() == 4 && vec[3] == "a"s);
+    vec.resize(2, "b"s);
+    EXPECT_TRUE(vec.size() == 2 && vec[1] == "a"s);
+}
+
+TEST_F(VectorTest, EraseRange) {
+    jtl_vector_t<int> vec{1, 2, 3, 4, 5, 6};
+    auto it = vec.erase(vec.begin() + 1, vec.begin() + 3);
+    EXPECT_TRUE(*it == 4 && vec.size() == 4 && vec[3] == 6);
+    vec.erase(vec.begin());
+    EXPECT_TRUE(vec.size() == 3 && vec[0] == 4);
+
+    jtl_vector_t<Tracked> vec2;
+    for (auto i = 0; i < 6; ++i) {
+        vec2.emplace_back(std::to_string(i));
+    }
+    Tracked::reset();
+    vec2.erase(vec2.begin() + 2, vec2.begin() + 4);
+    EXPECT_TRUE(vec2.size() == 4 && vec2[2].value == "4"s &&
+            Tracked::destructions == 2 && Tracked::copies == 0);
+}
+
+TEST_F(VectorTest, EraseIf) {
+    jtl_vector_t<int> vec{1, 2, 3, 4, 5, 6};
+    const auto removed =
+            jtl::erase_if(vec, [](const auto el) { return el % 2 == 0; });
+    EXPECT_TRUE(removed == 3 && vec.size() == 3 && vec[0] == 1 &&
+            vec[1] == 3 && vec[2] == 5);
+}
+
+TEST_F(VectorTest, TrackingAllocator) {
+    jtl::vector<int, jtl::tracking_allocator<int>,
+            jtl::RandomAccessIterator<int>>
+            vec;
+    jtl::vector<std::string, jtl::tracking_allocator<std::string>,
+            jtl::RandomAccessIterator<std::string>>
+            vec2;
+    for (auto i = 0; i < 100; ++i) {
+        vec.push_back(i);
+        vec2.push_back(std::to_string(i));
+    }
+    // Trivially relocatable elements grow in place through reallocate
+    const auto stats = vec.get_allocator().stats();
+    const auto stats2 = vec2.get_allocator().stats();
+    EXPECT_TRUE(stats.allocations == 1 && stats.reallocations == 7 &&
+            stats.live_bytes == 128 * sizeof(int));
+    EXPECT_TRUE(stats2.allocations == 8 && stats2.deallocations == 7 &&
+            stats2.live_bytes == 128 * sizeof(std::string));
+}
+
 TEST_F(VectorTest, ClearEmpty) {
     jtl_vector_t<int> vec{1, 2, 3, 4};
     vec.clear();